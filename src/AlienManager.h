@@ -2,110 +2,145 @@
 #define ALIENMANAGER_H
 
 #include <algorithm>
-#include <functional>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
 #include <random>
-#include <SFML/Graphics.hpp>
 #include <utility>
+#include <vector>
+#include <SFML/Graphics.hpp>
 
 #include "Alien.h"
+#include "BulletManager.h"
+#include "Profiler.h"
+#include "Utils.h"
 
-class AlienManager final : public sf::Drawable
+class AlienManager final
 {
-    static constexpr unsigned int Rows = 5;
-    static constexpr unsigned int Cols = 10;
-
-    std::vector<std::vector<Alien> > aliens{Rows};
-    std::vector<Alien *> exploding_aliens{};
-
-    const sf::Vector2f min_pos;
-    const sf::Vector2f max_pos;
-    const float alien_speed;
-    const int original_move_interval;
-    int move_interval;
-    std::int32_t move_timer = 0;
-    const float alien_step_down;
-    const float alien_scale;
-    int alive_alien_count = Rows * Cols;
-    int texture_step = 0;
-    bool all_aliens_dead = false;
-
-    Alien::Direction curr_direction = Alien::Direction::Right;
-
-    // Random engine for alien shooting
-    std::mt19937 rng{std::random_device{}()};
-    std::uniform_int_distribution<std::mt19937::result_type> dist100{1, 100};
-    static constexpr int alien_shot_chance = 5;
-
-    const sf::SoundBuffer alien_killed_sound_buffer{"../../assets/sounds/invader_killed.wav"};
-    sf::Sound alien_killed_sound{alien_killed_sound_buffer};
-
-    const std::array<sf::SoundBuffer, 4> alien_move_sound_buffers = {
-        sf::SoundBuffer("../../assets/sounds/invader_move1.wav"),
-        sf::SoundBuffer("../../assets/sounds/invader_move2.wav"),
-        sf::SoundBuffer("../../assets/sounds/invader_move3.wav"),
-        sf::SoundBuffer("../../assets/sounds/invader_move4.wav")
-    };
-
-    unsigned int current_sound_index = 0;
-    std::array<sf::Sound, 4> alien_move_sounds = {
-        sf::Sound(alien_move_sound_buffers.at(0)), sf::Sound(alien_move_sound_buffers.at(1)),
-        sf::Sound(alien_move_sound_buffers.at(2)), sf::Sound(alien_move_sound_buffers.at(3))
-    };
-
     public:
-        struct TwoTextures
+        // Size of the formation and the alien type of every row
+        struct Formation
         {
-            sf::Texture a;
-            sf::Texture b;
+            unsigned int rows;
+            unsigned int cols;
+            std::vector<Alien::Type> row_types;
+
+            // Largest formation accepted from the command line or a replay file
+            static constexpr std::uint64_t max_aliens = 1'000'000;
 
-            TwoTextures(const std::filesystem::path &file1, const std::filesystem::path &file2) : a(file1), b(file2)
+            // The arcade layout stretched to any size: the top fifth of the rows are As, the next two fifths Bs
+            // and the rest Cs. The default is the arcade's 5 x 10 formation.
+            static Formation make(const unsigned int rows = 5, const unsigned int cols = 10)
             {
+                Formation formation{rows, cols, std::vector<Alien::Type>(rows)};
+                for (unsigned int row = 0; row < rows; ++row)
+                {
+                    const unsigned int fifth = row * 5 / rows;
+                    formation.row_types[row] = fifth == 0
+                                                   ? Alien::Type::A
+                                                   : fifth < 3
+                                                         ? Alien::Type::B
+                                                         : Alien::Type::C;
+                }
+
+                return formation;
             }
         };
 
-        AlienManager(const std::vector<TwoTextures> &alien_textures,
-                     sf::Texture explosion_texture,
+    private:
+        using Word = std::uint64_t;
+        static constexpr unsigned int word_bits = 64;
+
+        // The shot chance is tuned for this many columns and scaled to the actual formation
+        static constexpr unsigned int classic_cols = 10;
+
+        const unsigned int rows;
+        const unsigned int cols;
+        const unsigned int count;
+        const std::vector<Alien::Type> row_types;
+
+        // The formation as flat arrays indexed by row * cols + col. Offsets are relative to formation_origin,
+        // so moving the whole formation is a single vector addition.
+        std::vector<Alien::Type> types = std::vector<Alien::Type>(count);
+        std::vector<std::uint8_t> states = std::vector<std::uint8_t>(count);
+        std::vector<sf::Vector2f> offsets = std::vector<sf::Vector2f>(count);
+        sf::Vector2f formation_origin;
+
+        std::vector<unsigned int> exploding_aliens{};
+
+        // Live aliens per column as a bit per row, and a bit per column that still has any.
+        // Only touched when an alien dies or the formation is reset, so edge and shooter lookups are bit scans.
+        const unsigned int words_per_column = (rows + word_bits - 1) / word_bits;
+        std::vector<Word> column_rows = std::vector<Word>(cols * words_per_column);
+        std::vector<Word> occupied_columns = std::vector<Word>((cols + word_bits - 1) / word_bits);
+
+        const sf::Vector2f min_pos;
+        const sf::Vector2f max_pos;
+        const float alien_speed;
+        const float original_move_interval;
+        float move_interval;
+        float move_timer = 0.0f;
+        const float alien_step_down;
+        const float alien_scale;
+        unsigned int alive_alien_count = count;
+        int texture_step = 0;
+        bool all_aliens_dead = false;
+
+        // Incremented whenever an alien's bounds or liveness change
+        unsigned int revision = 0;
+
+        Alien::Direction curr_direction = Alien::Direction::Right;
+
+        // Random engine for alien shooting
+        std::mt19937 rng;
+        static constexpr unsigned int alien_shot_chance = 5;
+        // Each column shoots with alien_shot_chance in this many, 100 for the classic formation. Wider formations
+        // roll against more so the whole formation fires as often as the classic one.
+        std::uniform_int_distribution<std::mt19937::result_type> shot_dist{
+            1, std::max(1u, 100 * cols / classic_cols)
+        };
+
+    public:
+        // alien_sizes holds the texture size of every alien type, indexed by Alien::typeIndex().
+        // alien_scale is reduced if the formation wouldn't fit between min_pos and max_pos otherwise.
+        AlienManager(const std::array<sf::Vector2u, 3> &alien_sizes,
                      const sf::Vector2f &min_pos,
                      const sf::Vector2f &max_pos,
                      const float alien_speed,
-                     const int time_step,
+                     const float time_step,
                      const float alien_step_down,
-                     const float alien_scale) : min_pos(min_pos), max_pos(max_pos), alien_speed(alien_speed),
-                                                original_move_interval(time_step), move_interval(time_step),
-                                                alien_step_down(alien_step_down), alien_scale(alien_scale),
-                                                alien_textures(alien_textures),
-                                                explosion_texture(std::move(explosion_texture))
-
+                     const float alien_scale,
+                     const std::uint32_t seed,
+                     const Formation &formation = Formation::make()) : rows(formation.rows), cols(formation.cols),
+                                                                       count(rows * cols),
+                                                                       row_types(formation.row_types),
+                                                                       min_pos(min_pos), max_pos(max_pos),
+                                                                       alien_speed(alien_speed),
+                                                                       original_move_interval(time_step),
+                                                                       move_interval(time_step),
+                                                                       alien_step_down(alien_step_down),
+                                                                       alien_scale(fitScale(alien_sizes, alien_scale)),
+                                                                       rng(seed)
         {
-            max_tex_size = std::max_element(alien_textures.begin(),
-                                            alien_textures.end(),
-                                            [](const TwoTextures &a, const TwoTextures &b)
-                                            {
-                                                return a.a.getSize().x - b.a.getSize().x;
-                                            })->a.getSize();
+            for (std::size_t i = 0; i < alien_sizes.size(); ++i)
+            {
+                alien_half_sizes[i] = sf::Vector2f(alien_sizes[i]) * this->alien_scale / 2.0f;
 
-            initAliens();
+                max_tex_size.x = std::max(max_tex_size.x, alien_sizes[i].x);
+                max_tex_size.y = std::max(max_tex_size.y, alien_sizes[i].y);
+            }
 
-            alien_killed_sound.setVolume(30.0f);
-            // alien_move_sound.setVolume(50.0f);
-        }
+            cell_spacing = {max_tex_size.x * this->alien_scale * 1.6f, max_tex_size.y * this->alien_scale * 1.5f};
 
-        void draw(sf::RenderTarget &target, const sf::RenderStates states) const override
-        {
-            for (auto &&row : aliens)
-            {
-                for (auto &&alien : row)
-                {
-                    if (!alien.isDead())
-                    {
-                        alien.draw(target, states);
-                    }
-                }
-            }
+            initAliens();
         }
 
-        void update(const std::int32_t delta_time, BulletManager &bullet_manager)
+        // Returns true if the formation took a step
+        bool update(const float delta_time, BulletManager &bullet_manager)
         {
+            PROFILE_ZONE("Aliens");
+
             move_timer += delta_time;
 
             if (move_timer >= move_interval)
@@ -113,112 +148,135 @@ class AlienManager final : public sf::Drawable
                 move(delta_time);
                 shoot(bullet_manager);
 
-                alien_move_sounds.at(current_sound_index).play();
-                current_sound_index = (current_sound_index + 1) % 4;
-
-                for (Alien *exploding_alien : exploding_aliens)
+                for (const unsigned int index : exploding_aliens)
                 {
-                    exploding_alien->state = Alien::State::Dead;
+                    states[index] = Alien::Dead;
                 }
                 exploding_aliens.clear();
 
                 move_timer -= move_interval;
+
+                return true;
             }
+
+            return false;
         }
 
-        // Returns true if enough time has passed for aliens to move
-        void move(const std::int32_t delta_time)
+        void move(const float delta_time)
         {
-            const auto maybeAlien = curr_direction == Alien::Direction::Left
-                                        ? findMostLeftAlien()
-                                        : findMostRightAlien();
+            const auto maybe_index = curr_direction == Alien::Direction::Left
+                                         ? findMostLeftAlien()
+                                         : findMostRightAlien();
 
-            if (!maybeAlien)
+            if (!maybe_index)
             {
-                // std::cerr << "Cannot find the most " << (curr_direction == Direction::Left ? "left" : "right") <<
-                // " alien, the vector is empty\n";
                 all_aliens_dead = true;
                 return;
             }
 
-            const Alien &edge_alien = maybeAlien->get();
+            const sf::Vector2f edge_pos = getPosition(*maybe_index);
 
             const bool hit_boundary = curr_direction == Alien::Direction::Left
-                                          ? edge_alien.getPosition().x - max_tex_size.x / 2.0f <= min_pos.x
-                                          : edge_alien.getPosition().x + max_tex_size.x / 2.0f >= max_pos.x;
+                                          ? edge_pos.x - max_tex_size.x / 2.0f <= min_pos.x
+                                          : edge_pos.x + max_tex_size.x / 2.0f >= max_pos.x;
 
             if (hit_boundary)
             {
                 curr_direction = curr_direction == Alien::Direction::Left
                                      ? Alien::Direction::Right
                                      : Alien::Direction::Left;
-                moveAll(delta_time, Alien::Direction::Down);
+                formation_origin.y += alien_step_down * delta_time;
             }
             else
             {
-                moveAll(delta_time, curr_direction);
+                formation_origin.x += (curr_direction == Alien::Direction::Left ? -alien_speed : alien_speed) *
+                    delta_time;
             }
 
             texture_step = (texture_step + 1) % 2;
-
-            changeTextures();
+            ++revision;
         }
 
         void shoot(BulletManager &bullet_manager)
         {
             // Each column has a random chance to shoot one bullet
-            for (unsigned int col = 0; col < Cols; ++col)
+            for (unsigned int col = 0; col < cols; ++col)
             {
-                if (dist100(rng) <= alien_shot_chance)
+                if (shot_dist(rng) <= alien_shot_chance)
                 {
-                    if (const std::optional<std::reference_wrapper<const Alien> > maybe_alien =
-                        findHighestInColumn(col))
+                    if (const std::optional<unsigned int> maybe_index = findHighestInColumn(col))
                     {
-                        maybe_alien->get().shoot(bullet_manager);
+                        bullet_manager.addBullet(getPosition(*maybe_index), Bullet::Type::Enemy);
                     }
                 }
             }
         }
 
         // Returns alien's score value if an alien was hit, 0 otherwise
-        // If alien is hit, sets its state to Alien::State::Exploding and changes texture to explosion
+        // If alien is hit, sets its state to Alien::Exploding
+        // The aliens sit on a regular lattice whose cells are wider than any alien, so each hit point can only be
+        // inside the alien of the cell it falls into. That makes the test constant time for any formation size.
         [[nodiscard]] int handleCollision(const Bullet &bullet)
         {
-            for (unsigned int row = 0; row < Rows; ++row)
+            auto upper_left = bullet.getUpperLeft();
+            auto upper_right = bullet.getUpperRight();
+
+            // Move the pixels by one to account for contains() not considering points lying on the edge
+            --upper_left.x;
+            ++upper_left.y;
+            ++upper_right.x;
+            ++upper_right.y;
+
+            std::optional<unsigned int> first = findCellAt(upper_left);
+            std::optional<unsigned int> second = findCellAt(upper_right);
+
+            // Test in index order, like a scan over the whole formation would
+            if (!first || (second && *second < *first))
             {
-                for (unsigned int col = 0; col < Cols; ++col)
+                std::swap(first, second);
+            }
+
+            for (const std::optional<unsigned int> &index : {first, second})
+            {
+                if (!index || !(states[*index] & Alien::Alive))
                 {
-                    if (Alien &curr_alien = aliens[row][col]; curr_alien.isAlive())
-                    {
-                        if (curr_alien.checkCollision(bullet))
-                        {
-                            curr_alien.state = Alien::State::Exploding;
-                            curr_alien.setTexture(explosion_texture);
-                            exploding_aliens.emplace_back(&curr_alien);
-                            --alive_alien_count;
-
-                            // scaled_percentage = min_percentage + current_count / max_count * (max_percentage - min_percentage)
-                            const float percentage = 0.50f + static_cast<float>(alive_alien_count) / (Rows * Cols) *
-                                0.50f;
-                            move_interval = percentage * original_move_interval;
-
-                            alien_killed_sound.play();
-
-                            return curr_alien.getScore();
-                        }
-                    }
+                    continue;
+                }
+
+                if (const sf::FloatRect bounds = getBounds(*index);
+                    bounds.contains(upper_left) || bounds.contains(upper_right))
+                {
+                    return kill(*index);
                 }
             }
 
             return 0;
         }
 
+        // Area covered by the formation's lattice, every alien is inside it
+        [[nodiscard]] sf::FloatRect getFormationBounds() const
+        {
+            const sf::Vector2f max_half_size = sf::Vector2f(max_tex_size) * alien_scale / 2.0f;
+            const sf::Vector2f lattice_size{(cols - 1) * cell_spacing.x, (rows - 1) * cell_spacing.y};
+            return {formation_origin - max_half_size, lattice_size + max_half_size * 2.0f};
+        }
+
         void restart()
         {
             initAliens();
+            exploding_aliens.clear();
             move_interval = original_move_interval;
-            alive_alien_count = Rows * Cols;
+            move_timer = 0.0f;
+            alive_alien_count = count;
+            texture_step = 0;
+            curr_direction = Alien::Direction::Right;
             all_aliens_dead = false;
+            ++revision;
+        }
+
+        void reseed(const std::uint32_t seed)
+        {
+            rng.seed(seed);
         }
 
         [[nodiscard]] bool allAliensDead() const
@@ -226,173 +284,188 @@ class AlienManager final : public sf::Drawable
             return all_aliens_dead;
         }
 
-    private:
-        const std::vector<TwoTextures> alien_textures;
-        const sf::Texture explosion_texture;
-        sf::Vector2u max_tex_size;
+        [[nodiscard]] unsigned int getRevision() const
+        {
+            return revision;
+        }
 
-        [[nodiscard]] Alien createAlien(const Alien::Type alien_type, const sf::Vector2f &pos) const
+        [[nodiscard]] unsigned int getCount() const
         {
-            const TwoTextures &two_textures = alien_textures.at(alienTypeToIndex(alien_type));
-            const sf::Texture &tex = two_textures.a;
-            return Alien{tex, alien_speed, alien_step_down, alien_scale, pos, alien_type};
+            return count;
         }
 
-        static constexpr int alienTypeToIndex(const Alien::Type type)
+        // Scale the aliens are drawn and collided at
+        [[nodiscard]] float getScale() const
         {
-            switch (type)
-            {
-                case Alien::Type::A: return 0;
-                case Alien::Type::B: return 1;
-                case Alien::Type::C: return 2;
-            }
+            return alien_scale;
+        }
 
-            return -1;
+        [[nodiscard]] Alien::Type getType(const unsigned int index) const
+        {
+            return types[index];
         }
 
-        void moveAll(const std::int32_t delta_time, const Alien::Direction direction)
+        // Mask of Alien::State bits
+        [[nodiscard]] std::uint8_t getState(const unsigned int index) const
         {
-            for (auto &&row : aliens)
-            {
-                for (auto &&alien : row)
-                {
-                    if (alien.isAlive())
-                    {
-                        alien.move(delta_time, direction);
-                    }
-                }
-            }
+            return states[index];
         }
 
-        void changeTextures()
+        // World position of the alien's centre
+        [[nodiscard]] sf::Vector2f getPosition(const unsigned int index) const
         {
-            const TwoTextures &two_tex1 = alien_textures.at(0);
-            const sf::Texture &tex1 = texture_step == 0 ? two_tex1.a : two_tex1.b;
+            return formation_origin + offsets[index];
+        }
 
-            // 1 row of As, 2 rows of Bs, 2 rows of Cs
-            for (unsigned int col = 0; col < Cols; ++col)
-            {
-                if (aliens[0][col].isAlive())
-                {
-                    aliens[0][col].setTexture(tex1);
-                }
-            }
+        [[nodiscard]] sf::FloatRect getBounds(const unsigned int index) const
+        {
+            const sf::Vector2f &half_size = alien_half_sizes[Alien::typeIndex(types[index])];
+            return {getPosition(index) - half_size, half_size * 2.0f};
+        }
 
-            const TwoTextures &two_tex2 = alien_textures.at(1);
-            const sf::Texture &tex2 = texture_step == 0 ? two_tex2.a : two_tex2.b;
-            for (unsigned int row = 1; row < 3; ++row)
+        // Animation frame the live aliens are currently showing (0 or 1)
+        [[nodiscard]] int getTextureStep() const
+        {
+            return texture_step;
+        }
+
+    private:
+        std::array<sf::Vector2f, 3> alien_half_sizes;
+        sf::Vector2u max_tex_size;
+        // Distance between neighbouring aliens' centres
+        sf::Vector2f cell_spacing;
+
+        // Index of the lattice cell whose alien could contain point, if the point is near the formation at all
+        [[nodiscard]] std::optional<unsigned int> findCellAt(const sf::Vector2f &point) const
+        {
+            const sf::Vector2f local = point - formation_origin;
+            const int col = static_cast<int>(std::floor(local.x / cell_spacing.x + 0.5f));
+            const int row = static_cast<int>(std::floor(local.y / cell_spacing.y + 0.5f));
+
+            if (col < 0 || row < 0 || col >= static_cast<int>(cols) || row >= static_cast<int>(rows))
             {
-                for (unsigned int col = 0; col < Cols; ++col)
-                {
-                    if (aliens[row][col].isAlive())
-                    {
-                        aliens[row][col].setTexture(tex2);
-                    }
-                }
+                return std::nullopt;
             }
 
-            const TwoTextures &two_tex3 = alien_textures.at(2);
-            const sf::Texture &tex3 = texture_step == 0 ? two_tex3.a : two_tex3.b;
-            for (unsigned int row = 3; row < Rows; ++row)
+            return row * cols + col;
+        }
+
+        // Sets the alien exploding and speeds up the formation, returns the alien's score value
+        int kill(const unsigned int index)
+        {
+            states[index] = Alien::Exploding;
+            exploding_aliens.emplace_back(index);
+            --alive_alien_count;
+
+            const unsigned int row = index / cols;
+            const unsigned int col = index % cols;
+            column_rows[col * words_per_column + row / word_bits] &= ~(Word{1} << row % word_bits);
+            if (!findHighestInColumn(col))
             {
-                for (unsigned  int col = 0; col < Cols; ++col)
-                {
-                    if (aliens[row][col].isAlive())
-                    {
-                        aliens[row][col].setTexture(tex3);
-                    }
-                }
+                occupied_columns[col / word_bits] &= ~(Word{1} << col % word_bits);
             }
+            ++revision;
+
+            // scaled_percentage = min_percentage + current_count / max_count * (max_percentage - min_percentage)
+            const float percentage = 0.50f + static_cast<float>(alive_alien_count) / count * 0.50f;
+            move_interval = percentage * original_move_interval;
+
+            return Alien::getScore(types[index]);
         }
 
-        [[nodiscard]] std::optional<std::reference_wrapper<const Alien> > findMostLeftAlien() const
+        [[nodiscard]] std::optional<unsigned int> findMostLeftAlien() const
         {
-            for (unsigned int col = 0; col < Cols; ++col)
+            for (unsigned int word = 0; word < occupied_columns.size(); ++word)
             {
-                for (unsigned int row = 0; row < Rows; ++row)
+                if (occupied_columns[word] != 0)
                 {
-                    if (aliens[row][col].isAlive())
-                    {
-                        return aliens[row][col];
-                    }
+                    return findHighestInColumn(word * word_bits + lowestSetBit(occupied_columns[word]));
                 }
             }
 
             return std::nullopt;
         }
 
-        [[nodiscard]] std::optional<std::reference_wrapper<const Alien> > findMostRightAlien() const
+        [[nodiscard]] std::optional<unsigned int> findMostRightAlien() const
         {
-            for (int col = Cols - 1; col >= 0; --col)
+            for (std::size_t word = occupied_columns.size(); word-- > 0;)
             {
-                for (unsigned int row = 0; row < Rows; ++row)
+                if (occupied_columns[word] != 0)
                 {
-                    if (aliens[row][col].isAlive())
-                    {
-                        return aliens[row][col];
-                    }
+                    return findHighestInColumn(word * word_bits + highestSetBit(occupied_columns[word]));
                 }
             }
 
             return std::nullopt;
         }
 
-        [[nodiscard]] std::optional<std::reference_wrapper<const Alien> > findHighestInColumn(
-            const unsigned int col) const
+        [[nodiscard]] std::optional<unsigned int> findHighestInColumn(const unsigned int col) const
         {
-            for (unsigned int row = 0; row < Rows; ++row)
+            const Word *column = &column_rows[col * words_per_column];
+            for (unsigned int word = 0; word < words_per_column; ++word)
             {
-                if (aliens[row][col].isAlive())
+                if (column[word] != 0)
                 {
-                    return aliens[row][col];
+                    return (word * word_bits + lowestSetBit(column[word])) * cols + col;
                 }
             }
 
             return std::nullopt;
         }
 
-        void initAliens()
+        // The largest scale up to alien_scale at which the whole formation fits between min_pos and max_pos, so
+        // large formations shrink instead of overlapping
+        [[nodiscard]] float fitScale(const std::array<sf::Vector2u, 3> &alien_sizes, const float alien_scale) const
         {
-            for (auto &&vector : aliens)
+            sf::Vector2f max_size{};
+            for (const sf::Vector2u &size : alien_sizes)
             {
-                vector.clear();
+                max_size.x = std::max(max_size.x, static_cast<float>(size.x));
+                max_size.y = std::max(max_size.y, static_cast<float>(size.y));
             }
 
-            float curr_x = min_pos.x;
-            float curr_y = min_pos.y;
-
-            const float gap_x = max_tex_size.x * alien_scale * 1.6f;
-            const float gap_y = max_tex_size.y * alien_scale * 1.5f;
+            const sf::Vector2f area = max_pos - min_pos;
+            return std::min({
+                alien_scale, area.x / (cols * max_size.x * 1.6f), area.y / (rows * max_size.y * 1.5f)
+            });
+        }
 
-            // 1 row of As, 2 rows of Bs, 2 rows of Cs
-            for (unsigned int col = 0; col < Cols; ++col)
+        // Sets the lowest bit_count bits of the words in [begin, end) and clears the rest
+        static void fillBits(const std::vector<Word>::iterator begin,
+                             const std::vector<Word>::iterator end,
+                             const unsigned int bit_count)
+        {
+            unsigned int remaining = bit_count;
+            for (auto word = begin; word != end; ++word)
             {
-                aliens.at(0).emplace_back(createAlien(Alien::Type::A, {curr_x, curr_y}));
-                curr_x += gap_x;
+                *word = remaining >= word_bits ? ~Word{0} : (Word{1} << remaining) - 1;
+                remaining -= std::min(remaining, word_bits);
             }
-            curr_y += gap_y;
+        }
 
-            for (int row = 1; row < 3; ++row)
+        void initAliens()
+        {
+            formation_origin = min_pos;
+
+            for (unsigned int row = 0; row < rows; ++row)
             {
-                curr_x = min_pos.x;
-                for (unsigned int col = 0; col < Cols; ++col)
+                for (unsigned int col = 0; col < cols; ++col)
                 {
-                    aliens.at(row).emplace_back(createAlien(Alien::Type::B, {curr_x, curr_y}));
-                    curr_x += gap_x;
+                    const unsigned int index = row * cols + col;
+                    types[index] = row_types[row];
+                    states[index] = Alien::Alive;
+                    offsets[index] = {col * cell_spacing.x, row * cell_spacing.y};
                 }
-                curr_y += gap_y;
             }
 
-            for (unsigned int row = 3; row < Rows; ++row)
+            for (unsigned int col = 0; col < cols; ++col)
             {
-                curr_x = min_pos.x;
-                for (unsigned int col = 0; col < Cols; ++col)
-                {
-                    aliens.at(row).emplace_back(createAlien(Alien::Type::C, {curr_x, curr_y}));
-                    curr_x += gap_x;
-                }
-                curr_y += gap_y;
+                fillBits(column_rows.begin() + col * words_per_column,
+                         column_rows.begin() + (col + 1) * words_per_column,
+                         rows);
             }
+
+            fillBits(occupied_columns.begin(), occupied_columns.end(), cols);
         }
 };
 
@@ -0,0 +1,248 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+#include <SFML/Graphics.hpp>
+
+#include "AssetPack.h"
+#include "AudioService.h"
+#include "ThreadPool.h"
+
+// Loads images, sounds and fonts from the asset pack or, for assets missing from it or without a pack, decodes them
+// from the loose files on worker threads. What has to happen on the main thread afterwards (texture and audio
+// uploads) is done by the callbacks passed to request(), which finish() runs in the order the assets become
+// available, so the first uploads overlap with the rest of the decoding.
+class AssetLoader
+{
+    using Asset = std::variant<sf::Image, SoundSamples, sf::Font>;
+
+    struct Decoded
+    {
+        std::size_t index;
+        Asset asset;
+    };
+
+    const std::filesystem::path root;
+    const AssetPack *pack;
+    const std::size_t thread_count;
+
+    std::vector<std::function<void(Asset &)>> callbacks{};
+
+    std::mutex mutex;
+    std::condition_variable decoded_available;
+    std::deque<Decoded> decoded{};
+    // First decoding error, rethrown by finish()
+    std::exception_ptr failure{};
+
+    // Started by the first asset that has to be decoded. Declared last so its workers stop before anything they use
+    // is destroyed.
+    std::unique_ptr<ThreadPool> pool{};
+
+    public:
+        // The pack, if any, must outlive the loader and everything loaded from it
+        explicit AssetLoader(std::filesystem::path root,
+                             const AssetPack *pack = nullptr,
+                             const std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency())) :
+            root(std::move(root)), pack(pack), thread_count(thread_count)
+        {
+        }
+
+        // Directory holding the shipped assets. Looked up from the executable's directory upwards, so the game
+        // finds them no matter which directory it's started from, be it next to the assets or in a build tree.
+        static std::filesystem::path findRoot()
+        {
+            const std::filesystem::path executable_dir = executablePath().parent_path();
+            for (std::filesystem::path dir = executable_dir; !dir.empty(); dir = dir.parent_path())
+            {
+                std::error_code error;
+                if (std::filesystem::is_directory(dir / "assets" / "images", error))
+                {
+                    return dir / "assets";
+                }
+
+                if (dir == dir.parent_path())
+                {
+                    break;
+                }
+            }
+
+            // Where a build in <repository>/<build dir>/bin expects them
+            return executable_dir / ".." / ".." / "assets";
+        }
+
+        // Where space_invaders_pack puts the pack in a build tree, next to the executable
+        static std::filesystem::path findPack()
+        {
+            return executablePath().parent_path() / "assets.pack";
+        }
+
+        // Queues the asset at name below the asset root, e.g. "images/bullet.png", for loading into Type, one of
+        // sf::Image, SoundSamples and sf::Font. on_loaded gets the asset on the thread that calls finish().
+        template<typename Type, typename OnLoaded>
+        void request(const std::string &name, OnLoaded on_loaded)
+        {
+            const std::size_t index = callbacks.size();
+            callbacks.emplace_back([on_loaded = std::move(on_loaded)](Asset &asset) mutable
+            {
+                on_loaded(std::get<Type>(std::move(asset)));
+            });
+
+            if (std::optional<Type> packed = pack ? fromPack<Type>(name) : std::nullopt)
+            {
+                const std::lock_guard lock{mutex};
+                decoded.push_back({index, Asset{std::move(*packed)}});
+                return;
+            }
+
+            if (!pool)
+            {
+                pool = std::make_unique<ThreadPool>(thread_count);
+            }
+
+            pool->submit([this, index, path = root / name]
+            {
+                try
+                {
+                    Asset asset{decode<Type>(path)};
+
+                    const std::lock_guard lock{mutex};
+                    decoded.push_back({index, std::move(asset)});
+                }
+                catch (...)
+                {
+                    const std::lock_guard lock{mutex};
+                    if (!failure)
+                    {
+                        failure = std::current_exception();
+                    }
+                }
+                decoded_available.notify_one();
+            });
+        }
+
+        // Hands every requested asset to its callback as soon as it's available, returns once all of them were.
+        // Rethrows the first decoding error. Stops the worker threads, nothing can be requested afterwards.
+        void finish()
+        {
+            for (std::size_t delivered = 0; delivered < callbacks.size(); ++delivered)
+            {
+                Decoded next;
+                {
+                    std::unique_lock lock{mutex};
+                    decoded_available.wait(lock, [this]
+                    {
+                        return failure || !decoded.empty();
+                    });
+
+                    if (failure)
+                    {
+                        lock.unlock();
+                        pool.reset();
+                        std::rethrow_exception(failure);
+                    }
+
+                    next = std::move(decoded.front());
+                    decoded.pop_front();
+                }
+
+                callbacks[next.index](next.asset);
+            }
+
+            pool.reset();
+        }
+
+    private:
+        // Nothing if the pack doesn't hold the asset
+        template<typename Type>
+        std::optional<Type> fromPack(const std::string &name) const
+        {
+            if constexpr (std::is_same_v<Type, sf::Image>)
+            {
+                return pack->getImage(name);
+            }
+            else if constexpr (std::is_same_v<Type, SoundSamples>)
+            {
+                return pack->getSound(name);
+            }
+            else
+            {
+                // Reads the font straight from the mapping, throws if it isn't a font
+                if (const auto bytes = pack->getBytes(name))
+                {
+                    return Type{bytes->first, bytes->second};
+                }
+
+                return std::nullopt;
+            }
+        }
+
+        template<typename Type>
+        static Type decode(const std::filesystem::path &path)
+        {
+            if constexpr (std::is_same_v<Type, SoundSamples>)
+            {
+                return SoundSamples::decode(path);
+            }
+            else
+            {
+                // sf::Image and sf::Font throw if the file can't be read
+                return Type{path};
+            }
+        }
+
+        static std::filesystem::path executablePath()
+        {
+            std::error_code error;
+#if defined(_WIN32)
+            std::wstring path(MAX_PATH, L'\0');
+            path.resize(GetModuleFileNameW(nullptr, path.data(), static_cast<DWORD>(path.size())));
+            return path;
+#elif defined(__APPLE__)
+            std::uint32_t size = 0;
+            _NSGetExecutablePath(nullptr, &size);
+            std::string path(size, '\0');
+            if (_NSGetExecutablePath(path.data(), &size) == 0)
+            {
+                return std::filesystem::canonical(path.c_str(), error);
+            }
+#else
+            if (std::filesystem::path path = std::filesystem::read_symlink("/proc/self/exe", error); !error)
+            {
+                return path;
+            }
+#endif
+            // Not where the executable is, but the best guess left
+            return std::filesystem::current_path(error) / "executable";
+        }
+};
+
+#endif //ASSETLOADER_H
@@ -0,0 +1,511 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <SFML/Graphics.hpp>
+
+#include "AudioService.h"
+
+// A file mapped read-only into memory, unmapped when destroyed
+class MappedFile
+{
+    const std::uint8_t *data = nullptr;
+    std::size_t size = 0;
+#if defined(_WIN32)
+    HANDLE mapping = nullptr;
+#endif
+
+    public:
+        MappedFile() = default;
+
+        MappedFile(MappedFile &&other) noexcept
+        {
+            swap(other);
+        }
+
+        MappedFile &operator=(MappedFile &&other) noexcept
+        {
+            MappedFile{std::move(other)}.swap(*this);
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+#if defined(_WIN32)
+            if (data)
+            {
+                UnmapViewOfFile(data);
+                CloseHandle(mapping);
+            }
+#else
+            if (data)
+            {
+                munmap(const_cast<std::uint8_t *>(data), size);
+            }
+#endif
+        }
+
+        // Returns nothing if the file doesn't exist, is empty or can't be mapped
+        static std::optional<MappedFile> open(const std::filesystem::path &path)
+        {
+            MappedFile file;
+#if defined(_WIN32)
+            const HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (handle == INVALID_HANDLE_VALUE)
+            {
+                return std::nullopt;
+            }
+
+            LARGE_INTEGER file_size{};
+            if (GetFileSizeEx(handle, &file_size) && file_size.QuadPart > 0)
+            {
+                file.mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (file.mapping)
+                {
+                    file.data = static_cast<const std::uint8_t *>(MapViewOfFile(file.mapping, FILE_MAP_READ, 0, 0,
+                                                                                0));
+                    file.size = static_cast<std::size_t>(file_size.QuadPart);
+                    if (!file.data)
+                    {
+                        CloseHandle(file.mapping);
+                    }
+                }
+            }
+            // The mapping keeps the file open
+            CloseHandle(handle);
+#else
+            const int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0)
+            {
+                return std::nullopt;
+            }
+
+            struct stat status{};
+            if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+            {
+                void *mapped = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE,
+                                    descriptor, 0);
+                if (mapped != MAP_FAILED)
+                {
+                    // Everything in the pack is read at startup, so ask for it to be read ahead in one go
+                    madvise(mapped, static_cast<std::size_t>(status.st_size), MADV_WILLNEED);
+                    file.data = static_cast<const std::uint8_t *>(mapped);
+                    file.size = static_cast<std::size_t>(status.st_size);
+                }
+            }
+            // The mapping keeps the file open
+            close(descriptor);
+#endif
+            if (!file.data)
+            {
+                return std::nullopt;
+            }
+
+            return file;
+        }
+
+        [[nodiscard]] const std::uint8_t *getData() const
+        {
+            return data;
+        }
+
+        [[nodiscard]] std::size_t getSize() const
+        {
+            return size;
+        }
+
+    private:
+        void swap(MappedFile &other) noexcept
+        {
+            std::swap(data, other.data);
+            std::swap(size, other.size);
+#if defined(_WIN32)
+            std::swap(mapping, other.mapping);
+#endif
+        }
+};
+
+// Every asset in one file, already decoded: images as RGBA pixels, sounds as little endian 16 bit PCM and fonts as
+// the bytes of the font file. Built by space_invaders_pack and memory-mapped at runtime, so loading an asset is a
+// lookup in the index and a copy (or not even that) instead of opening and decoding a file.
+// Assets are named by their path below the assets directory, e.g. "images/bullet.png".
+class AssetPack
+{
+    static constexpr std::array<char, 4> magic = {'S', 'I', 'A', 'P'};
+    static constexpr std::uint16_t format_version = 1;
+    // Start of every asset's data, enough for the samples to be read in place
+    static constexpr std::uint64_t data_alignment = 16;
+
+    public:
+        enum class Kind : std::uint8_t
+        {
+            Image = 1,
+            Sound = 2,
+            Bytes = 3
+        };
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            Kind kind;
+            // From the start of the file
+            std::uint64_t offset;
+            std::uint64_t size;
+            // Width and height of an image, sample rate and channel count of a sound
+            std::array<std::uint32_t, 2> parameters;
+            // sf::SoundChannel values of a sound
+            std::vector<std::uint8_t> channel_map;
+        };
+
+        MappedFile file;
+        // Sorted by name
+        std::vector<Entry> entries{};
+
+    public:
+        // Collects assets in memory and writes them out as a pack
+        class Writer
+        {
+            struct Pending
+            {
+                Entry entry;
+                std::vector<std::uint8_t> data;
+            };
+
+            std::vector<Pending> pending{};
+
+            public:
+                void addImage(std::string name, const sf::Image &image)
+                {
+                    const std::uint8_t *pixels = image.getPixelsPtr();
+                    const std::size_t size = std::size_t{image.getSize().x} * image.getSize().y * 4;
+                    pending.push_back({
+                        {std::move(name), Kind::Image, 0, size, {image.getSize().x, image.getSize().y}, {}},
+                        std::vector<std::uint8_t>(pixels, pixels + size)
+                    });
+                }
+
+                void addSound(std::string name, const SoundSamples &sound)
+                {
+                    std::vector<std::uint8_t> data(sound.sample_count * sizeof(std::int16_t));
+                    for (std::uint64_t i = 0; i < sound.sample_count; ++i)
+                    {
+                        const auto sample = static_cast<std::uint16_t>(sound.data()[i]);
+                        data[i * 2] = static_cast<std::uint8_t>(sample & 0xFF);
+                        data[i * 2 + 1] = static_cast<std::uint8_t>(sample >> 8);
+                    }
+
+                    std::vector<std::uint8_t> channel_map;
+                    for (const sf::SoundChannel channel : sound.channel_map)
+                    {
+                        channel_map.push_back(static_cast<std::uint8_t>(channel));
+                    }
+
+                    pending.push_back({
+                        {
+                            std::move(name), Kind::Sound, 0, data.size(), {sound.sample_rate, sound.channel_count},
+                            std::move(channel_map)
+                        },
+                        std::move(data)
+                    });
+                }
+
+                void addBytes(std::string name, std::vector<std::uint8_t> bytes)
+                {
+                    const std::size_t size = bytes.size();
+                    pending.push_back({{std::move(name), Kind::Bytes, 0, size, {0, 0}, {}}, std::move(bytes)});
+                }
+
+                // The index comes first, then the data of every asset in name order
+                bool write(const std::filesystem::path &path)
+                {
+                    std::sort(pending.begin(), pending.end(), [](const Pending &a, const Pending &b)
+                    {
+                        return a.entry.name < b.entry.name;
+                    });
+
+                    std::uint64_t offset = magic.size() + sizeof(format_version) + sizeof(std::uint32_t);
+                    for (const Pending &asset : pending)
+                    {
+                        // Name size, name, kind, offset, size, parameters, channel count, channel map
+                        offset += 2 + asset.entry.name.size() + 1 + 8 + 8 + 4 + 4 + 1 + asset.entry.channel_map.size();
+                    }
+                    for (Pending &asset : pending)
+                    {
+                        offset = align(offset);
+                        asset.entry.offset = offset;
+                        offset += asset.entry.size;
+                    }
+
+                    std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+                    if (!stream)
+                    {
+                        return false;
+                    }
+
+                    stream.write(magic.data(), magic.size());
+                    writeFixed(stream, format_version);
+                    writeFixed(stream, static_cast<std::uint32_t>(pending.size()));
+                    for (const Pending &asset : pending)
+                    {
+                        const Entry &entry = asset.entry;
+                        writeFixed(stream, static_cast<std::uint16_t>(entry.name.size()));
+                        stream.write(entry.name.data(), static_cast<std::streamsize>(entry.name.size()));
+                        writeFixed(stream, static_cast<std::uint8_t>(entry.kind));
+                        writeFixed(stream, entry.offset);
+                        writeFixed(stream, entry.size);
+                        writeFixed(stream, entry.parameters[0]);
+                        writeFixed(stream, entry.parameters[1]);
+                        writeFixed(stream, static_cast<std::uint8_t>(entry.channel_map.size()));
+                        for (const std::uint8_t channel : entry.channel_map)
+                        {
+                            writeFixed(stream, channel);
+                        }
+                    }
+
+                    for (const Pending &asset : pending)
+                    {
+                        while (static_cast<std::uint64_t>(stream.tellp()) < asset.entry.offset)
+                        {
+                            stream.put('\0');
+                        }
+                        stream.write(reinterpret_cast<const char *>(asset.data.data()),
+                                     static_cast<std::streamsize>(asset.data.size()));
+                    }
+
+                    return static_cast<bool>(stream);
+                }
+        };
+
+        // Returns nothing if there is no pack at path or it isn't of this format version
+        static std::optional<AssetPack> open(const std::filesystem::path &path)
+        {
+            std::optional<MappedFile> mapped = MappedFile::open(path);
+            if (!mapped)
+            {
+                return std::nullopt;
+            }
+
+            AssetPack pack;
+            pack.file = std::move(*mapped);
+            if (!pack.readIndex())
+            {
+                return std::nullopt;
+            }
+
+            return pack;
+        }
+
+        // Of the whole pack file
+        [[nodiscard]] std::size_t getSize() const
+        {
+            return file.getSize();
+        }
+
+        [[nodiscard]] bool contains(const std::string_view name) const
+        {
+            return find(name) != nullptr;
+        }
+
+        // Nothing if the pack holds no image of that name
+        [[nodiscard]] std::optional<sf::Image> getImage(const std::string_view name) const
+        {
+            const Entry *entry = find(name, Kind::Image);
+            if (!entry)
+            {
+                return std::nullopt;
+            }
+
+            return sf::Image{{entry->parameters[0], entry->parameters[1]}, file.getData() + entry->offset};
+        }
+
+        // The samples point into the pack (every supported platform is little endian), which must outlive them.
+        // Nothing if the pack holds no such sound.
+        [[nodiscard]] std::optional<SoundSamples> getSound(const std::string_view name) const
+        {
+            const Entry *entry = find(name, Kind::Sound);
+            if (!entry)
+            {
+                return std::nullopt;
+            }
+
+            SoundSamples sound;
+            sound.mapped = reinterpret_cast<const std::int16_t *>(file.getData() + entry->offset);
+            sound.sample_count = entry->size / sizeof(std::int16_t);
+            sound.sample_rate = entry->parameters[0];
+            sound.channel_count = entry->parameters[1];
+            for (const std::uint8_t channel : entry->channel_map)
+            {
+                sound.channel_map.push_back(static_cast<sf::SoundChannel>(channel));
+            }
+
+            return sound;
+        }
+
+        // Pointer and size of the bytes stored under name, they live as long as the pack. Nothing if there are none.
+        [[nodiscard]] std::optional<std::pair<const std::uint8_t *, std::size_t>> getBytes(
+            const std::string_view name) const
+        {
+            const Entry *entry = find(name, Kind::Bytes);
+            if (!entry)
+            {
+                return std::nullopt;
+            }
+
+            return std::pair{file.getData() + entry->offset, static_cast<std::size_t>(entry->size)};
+        }
+
+    private:
+        AssetPack() = default;
+
+        [[nodiscard]] const Entry *find(const std::string_view name) const
+        {
+            const auto entry = std::lower_bound(entries.begin(), entries.end(), name,
+                                                [](const Entry &a, const std::string_view b)
+                                                {
+                                                    return a.name < b;
+                                                });
+            return entry != entries.end() && entry->name == name ? &*entry : nullptr;
+        }
+
+        [[nodiscard]] const Entry *find(const std::string_view name, const Kind kind) const
+        {
+            const Entry *entry = find(name);
+            return entry && entry->kind == kind ? entry : nullptr;
+        }
+
+        // Checks every entry lies inside the file, so lookups don't have to
+        bool readIndex()
+        {
+            const std::uint8_t *data = file.getData();
+            const std::size_t size = file.getSize();
+            std::size_t position = 0;
+
+            const auto read = [&](void *target, const std::size_t count)
+            {
+                if (size - position < count)
+                {
+                    return false;
+                }
+
+                // Empty names and channel maps have no storage to copy to
+                if (count != 0)
+                {
+                    std::memcpy(target, data + position, count);
+                }
+                position += count;
+                return true;
+            };
+
+            std::array<char, 4> file_magic{};
+            std::uint16_t version = 0;
+            std::uint32_t entry_count = 0;
+            if (!read(file_magic.data(), file_magic.size()) || file_magic != magic
+                || !readFixed(read, version) || version != format_version || !readFixed(read, entry_count))
+            {
+                return false;
+            }
+
+            for (std::uint32_t i = 0; i < entry_count; ++i)
+            {
+                Entry entry{};
+                std::uint16_t name_size = 0;
+                std::uint8_t kind = 0;
+                std::uint8_t channel_count = 0;
+                if (!readFixed(read, name_size))
+                {
+                    return false;
+                }
+
+                entry.name.resize(name_size);
+                if (!read(entry.name.data(), name_size) || !readFixed(read, kind) || !readFixed(read, entry.offset)
+                    || !readFixed(read, entry.size) || !readFixed(read, entry.parameters[0])
+                    || !readFixed(read, entry.parameters[1]) || !readFixed(read, channel_count))
+                {
+                    return false;
+                }
+
+                entry.channel_map.resize(channel_count);
+                if (!read(entry.channel_map.data(), channel_count))
+                {
+                    return false;
+                }
+
+                entry.kind = static_cast<Kind>(kind);
+                if (entry.offset > size || entry.size > size - entry.offset || entry.offset % data_alignment != 0
+                    || (entry.kind == Kind::Image
+                        && entry.size != std::uint64_t{entry.parameters[0]} * entry.parameters[1] * 4)
+                    || (entry.kind == Kind::Sound && entry.size % sizeof(std::int16_t) != 0)
+                    || (!entries.empty() && entries.back().name >= entry.name))
+                {
+                    return false;
+                }
+
+                entries.push_back(std::move(entry));
+            }
+
+            return true;
+        }
+
+        static std::uint64_t align(const std::uint64_t offset)
+        {
+            return (offset + data_alignment - 1) / data_alignment * data_alignment;
+        }
+
+        template<typename T>
+        static void writeFixed(std::ostream &stream, const T value)
+        {
+            for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+            {
+                stream.put(static_cast<char>((static_cast<std::uint64_t>(value) >> byte * 8) & 0xFF));
+            }
+        }
+
+        template<typename Read, typename T>
+        static bool readFixed(Read &read, T &value)
+        {
+            std::array<std::uint8_t, sizeof(T)> bytes{};
+            if (!read(bytes.data(), bytes.size()))
+            {
+                return false;
+            }
+
+            std::uint64_t result = 0;
+            for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+            {
+                result |= static_cast<std::uint64_t>(bytes[byte]) << byte * 8;
+            }
+            value = static_cast<T>(result);
+            return true;
+        }
+};
+
+#endif //ASSETPACK_H
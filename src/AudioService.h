@@ -0,0 +1,234 @@
+#ifndef AUDIOSERVICE_H
+#define AUDIOSERVICE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <SFML/Audio.hpp>
+
+// 16 bit PCM samples of a whole sound, decoded off the audio device so it can be done on any thread. Either owns
+// the samples or points to samples owned by something else, such as a mapped asset pack.
+struct SoundSamples
+{
+    std::vector<std::int16_t> decoded{};
+    const std::int16_t *mapped = nullptr;
+    std::uint64_t sample_count = 0;
+    unsigned int sample_rate = 0;
+    unsigned int channel_count = 0;
+    std::vector<sf::SoundChannel> channel_map{};
+
+    // Throws if the file can't be read
+    static SoundSamples decode(const std::filesystem::path &path)
+    {
+        sf::InputSoundFile file;
+        if (!file.openFromFile(path))
+        {
+            throw std::runtime_error("Failed to load sound " + path.string());
+        }
+
+        SoundSamples sound;
+        sound.decoded.resize(file.getSampleCount());
+        sound.decoded.resize(file.read(sound.decoded.data(), sound.decoded.size()));
+        sound.sample_count = sound.decoded.size();
+        sound.sample_rate = file.getSampleRate();
+        sound.channel_count = file.getChannelCount();
+        sound.channel_map = file.getChannelMap();
+
+        return sound;
+    }
+
+    [[nodiscard]] const std::int16_t *data() const
+    {
+        return mapped ? mapped : decoded.data();
+    }
+};
+
+// Where the sounds actually go. Voices are numbered 0 to the voice count passed to the AudioService.
+class AudioBackend
+{
+    public:
+        virtual ~AudioBackend() = default;
+
+        // Takes a copy of the samples, returns false if the backend can't use them
+        virtual bool load(const SoundSamples &sound) = 0;
+        // Starts sound (in load order) on voice, cutting off whatever the voice was playing. Mustn't block.
+        virtual void play(std::size_t voice, std::size_t sound, float volume) = 0;
+        [[nodiscard]] virtual bool isPlaying(std::size_t voice) const = 0;
+};
+
+// Plays through the default audio device, the samples of every sound are kept in memory
+class SfmlAudioBackend final : public AudioBackend
+{
+    // sf::Sound refers to its buffer, so buffers must not move once loaded
+    std::vector<std::unique_ptr<sf::SoundBuffer>> buffers{};
+    std::vector<std::optional<sf::Sound>> voices;
+
+    public:
+        explicit SfmlAudioBackend(const std::size_t voice_count) : voices(voice_count)
+        {
+        }
+
+        bool load(const SoundSamples &sound) override
+        {
+            auto buffer = std::make_unique<sf::SoundBuffer>();
+            if (!buffer->loadFromSamples(sound.data(), sound.sample_count, sound.channel_count,
+                                         sound.sample_rate, sound.channel_map))
+            {
+                return false;
+            }
+
+            buffers.push_back(std::move(buffer));
+            return true;
+        }
+
+        void play(const std::size_t voice, const std::size_t sound, const float volume) override
+        {
+            if (voices[voice])
+            {
+                voices[voice]->stop();
+                voices[voice]->setBuffer(*buffers[sound]);
+            }
+            else
+            {
+                voices[voice].emplace(*buffers[sound]);
+            }
+
+            voices[voice]->setVolume(volume);
+            voices[voice]->play();
+        }
+
+        [[nodiscard]] bool isPlaying(const std::size_t voice) const override
+        {
+            return voices[voice] && voices[voice]->getStatus() == sf::Sound::Status::Playing;
+        }
+};
+
+// Discards everything without touching an audio device
+class NullAudioBackend final : public AudioBackend
+{
+    public:
+        bool load(const SoundSamples &) override
+        {
+            return true;
+        }
+
+        void play(std::size_t, std::size_t, float) override
+        {
+        }
+
+        [[nodiscard]] bool isPlaying(std::size_t) const override
+        {
+            return false;
+        }
+};
+
+// Keeps every sound in memory and plays them on a fixed pool of voices, so a sound played again while it's still
+// playing overlaps instead of restarting. When every voice is busy the oldest sound of the lowest priority is cut
+// off, unless the new sound's priority is lower still, in which case the new sound is dropped.
+class AudioService
+{
+    public:
+        enum class Priority : std::uint8_t
+        {
+            Low,
+            Normal,
+            High
+        };
+
+        // Returned by load(), identifies a sound for play()
+        struct Handle
+        {
+            std::size_t index;
+        };
+
+    private:
+        struct Sound
+        {
+            Priority priority;
+            float volume;
+        };
+
+        struct Voice
+        {
+            Priority priority = Priority::Low;
+            // When the voice was last started, in play() calls
+            std::uint64_t started = 0;
+        };
+
+        std::unique_ptr<AudioBackend> backend;
+        std::vector<Sound> sounds{};
+        std::vector<Voice> voices;
+        std::uint64_t play_count = 0;
+
+    public:
+        static constexpr std::size_t default_voice_count = 16;
+
+        explicit AudioService(std::unique_ptr<AudioBackend> backend, const std::size_t voice_count) :
+            backend(std::move(backend)), voices(voice_count)
+        {
+        }
+
+        // Sound through the default audio device, or nowhere when muted
+        static AudioService create(const bool muted, const std::size_t voice_count = default_voice_count)
+        {
+            if (muted)
+            {
+                return AudioService{std::make_unique<NullAudioBackend>(), voice_count};
+            }
+
+            return AudioService{std::make_unique<SfmlAudioBackend>(voice_count), voice_count};
+        }
+
+        // Throws if the backend can't use the samples
+        Handle load(const SoundSamples &sound, const Priority priority, const float volume = 100.0f)
+        {
+            if (!backend->load(sound))
+            {
+                throw std::runtime_error("Failed to load sound samples");
+            }
+
+            sounds.push_back({priority, volume});
+            return {sounds.size() - 1};
+        }
+
+        void play(const Handle sound)
+        {
+            const Sound &played = sounds[sound.index];
+            if (const std::optional<std::size_t> voice = findVoice(played.priority))
+            {
+                voices[*voice] = {played.priority, ++play_count};
+                backend->play(*voice, sound.index, played.volume);
+            }
+        }
+
+    private:
+        // A free voice, or else the one to steal. Nothing if every voice plays something more important.
+        [[nodiscard]] std::optional<std::size_t> findVoice(const Priority priority) const
+        {
+            std::optional<std::size_t> victim;
+            for (std::size_t i = 0; i < voices.size(); ++i)
+            {
+                if (!backend->isPlaying(i))
+                {
+                    return i;
+                }
+
+                const Voice &voice = voices[i];
+                if (voice.priority <= priority && (!victim || voice.priority < voices[*victim].priority
+                                                   || (voice.priority == voices[*victim].priority
+                                                       && voice.started < voices[*victim].started)))
+                {
+                    victim = i;
+                }
+            }
+
+            return victim;
+        }
+};
+
+#endif //AUDIOSERVICE_H
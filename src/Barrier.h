@@ -1,89 +1,252 @@
 #ifndef BARRIER_H
 #define BARRIER_H
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
 #include <SFML/Graphics.hpp>
 
 #include "Bullet.h"
+#include "ResourceRegistry.h"
 
-class Barrier final : public sf::Drawable
+class Barrier final
 {
-    sf::Image image;
-    sf::Texture texture;
-    sf::Sprite sprite;
+    using Word = std::uint64_t;
+    static constexpr unsigned int word_bits = 64;
 
+    static constexpr float bullet_hit_radius = 50.0f;
+    // A crater mask row is a single Word, so barriers drawn small enough to need bigger craters get this size
+    static constexpr int max_crater_half_size = (word_bits - 1) / 2;
+    static_assert(2 * max_crater_half_size + 1 <= static_cast<int>(word_bits));
+    static constexpr std::size_t crater_mask_count = 32;
+
+    // The undamaged barrier, shared by every barrier
+    const ResourceHandle<sf::Image> original_image;
+    const sf::Vector2f position;
     const float scale;
 
-    static constexpr float bullet_hit_radius = 50.0f;
-    std::mt19937 rng{std::random_device{}()};
-    std::uniform_int_distribution<std::mt19937::result_type> dist100{1, 100};
+    // Solidity as one bit per pixel, row by row, each row padded to whole words
+    const unsigned int width;
+    const unsigned int height;
+    const unsigned int words_per_row;
+    std::vector<Word> original_solid;
+    std::vector<Word> solid;
 
-    public:
-        Barrier(const std::filesystem::path &path, const float scale, const sf::Vector2f &pos) : image(path),
-            texture(path), sprite(texture), scale(scale)
-        {
-            //Set origin to center
-            sprite.setOrigin({
-                static_cast<float>(texture.getSize().x) / 2.0f, static_cast<float>(texture.getSize().y) / 2.0f
-            });
+    // Erosion pattern around a hit: crater_size rows of crater_size bits, each bit kept with 50% chance.
+    // Precomputed once so a hit picks a random mask instead of rolling the dice for every pixel.
+    const int crater_half_size;
+    std::array<std::vector<Word>, crater_mask_count> crater_masks{};
+
+    // Display image derived from the bits, only refreshed where damage happened when the renderer asks for it
+    sf::Image image;
 
-            sprite.setScale({scale, scale});
-            sprite.setPosition(pos);
+    // Bounding box of the pixels changed since the renderer last took it
+    std::optional<sf::IntRect> dirty_rect{};
 
-            sprite.setOrigin({0.0, 0.0});
-        }
+    std::mt19937 rng;
+    std::uniform_int_distribution<std::size_t> crater_dist{0, crater_mask_count - 1};
 
-        void draw(sf::RenderTarget &target, sf::RenderStates states) const override
+    public:
+        // pos is the top left corner of the barrier
+        Barrier(ResourceHandle<sf::Image> original, const float scale, const sf::Vector2f &pos,
+                const std::uint32_t seed) :
+            original_image(std::move(original)), position(pos), scale(scale), width(original_image->getSize().x),
+            height(original_image->getSize().y), words_per_row((width + word_bits - 1) / word_bits),
+            original_solid(words_per_row * height),
+            crater_half_size(std::min(static_cast<int>(bullet_hit_radius / scale) / 2, max_crater_half_size)),
+            image(*original_image), rng(seed)
         {
-            target.draw(sprite, states);
+            for (unsigned int y = 0; y < height; ++y)
+            {
+                for (unsigned int x = 0; x < width; ++x)
+                {
+                    if (original_image->getPixel({x, y}).a != 0)
+                    {
+                        original_solid[y * words_per_row + x / word_bits] |= Word{1} << x % word_bits;
+                    }
+                }
+            }
+            solid = original_solid;
+
+            initCraterMasks();
         }
 
         bool handleCollision(const Bullet &bullet)
         {
-            const auto pixel = sf::Vector2u((bullet.sprite.getPosition() - sprite.getPosition()) / scale);
+            const sf::Vector2f local = (bullet.getPosition() - position) / scale;
+            const sf::Vector2i pixel{static_cast<int>(std::floor(local.x)), static_cast<int>(std::floor(local.y))};
 
-            if (!imageContainsPixel(pixel))
+            if (!isSolid(pixel))
             {
                 return false;
             }
 
-            // If pixel is transparent
-            if (image.getPixel(pixel).a == 0)
+            stampCrater(pixel, crater_masks[crater_dist(rng)]);
+
+            const int crater_size = 2 * crater_half_size + 1;
+            markDirty({pixel - sf::Vector2i{crater_half_size, crater_half_size}, {crater_size, crater_size}});
+
+            return true;
+        }
+
+        [[nodiscard]] bool isSolid(const sf::Vector2i pixel) const
+        {
+            if (pixel.x < 0 || pixel.y < 0 || pixel.x >= static_cast<int>(width) || pixel.y >= static_cast<int>(height))
             {
                 return false;
             }
 
-            const int range = bullet_hit_radius / scale;
+            return (solid[pixel.y * words_per_row + pixel.x / word_bits] >> (pixel.x % word_bits)) & 1;
+        }
+
+        // Restores the undamaged barrier and reseeds its erosion
+        void restart(const std::uint32_t seed)
+        {
+            solid = original_solid;
+            rng.seed(seed);
+            markDirty({{0, 0}, sf::Vector2i(original_image->getSize())});
+        }
+
+        // Up to date in the areas returned by takeDirtyRect()
+        [[nodiscard]] const sf::Image &getImage() const
+        {
+            return image;
+        }
+
+        // Returns the area changed since the last call, if any, and brings the image up to date there.
+        // Lets the renderer upload only the damaged pixels, at most once per frame however many hits there were.
+        [[nodiscard]] std::optional<sf::IntRect> takeDirtyRect()
+        {
+            if (dirty_rect)
+            {
+                refreshImage(*dirty_rect);
+            }
+
+            return std::exchange(dirty_rect, std::nullopt);
+        }
+
+        [[nodiscard]] sf::Vector2f getPosition() const
+        {
+            return position;
+        }
+
+        [[nodiscard]] float getScale() const
+        {
+            return scale;
+        }
+
+        [[nodiscard]] sf::FloatRect getBounds() const
+        {
+            return {position, sf::Vector2f(original_image->getSize()) * scale};
+        }
+
+    private:
+        void initCraterMasks()
+        {
+            // Fixed seed, the masks are part of the barrier's shape and shouldn't depend on the game's seed
+            std::mt19937 mask_rng{0};
+            std::uniform_int_distribution<std::mt19937::result_type> dist100{1, 100};
 
-            for (int x = -range / 2; x <= range / 2; ++x)
+            const int crater_size = 2 * crater_half_size + 1;
+            for (std::vector<Word> &mask : crater_masks)
             {
-                for (int y = -range / 2; y <= range / 2; ++y)
+                mask.assign(crater_size, 0);
+                for (Word &row : mask)
                 {
-                    if (dist100(rng) <= 50)
+                    for (int bit = 0; bit < crater_size; ++bit)
                     {
-                        if (const sf::Vector2u curr = {pixel.x + x, pixel.y + y}; imageContainsPixel(curr))
+                        if (dist100(mask_rng) <= 50)
                         {
-                            image.setPixel(curr, sf::Color::Transparent);
+                            row |= Word{1} << bit;
                         }
                     }
                 }
             }
+        }
+
+        // Clears the mask's bits around center, one word operation per mask row and touched word
+        void stampCrater(const sf::Vector2i center, const std::vector<Word> &mask)
+        {
+            const int top = center.y - crater_half_size;
+            const int left = center.x - crater_half_size;
 
-            if (!texture.loadFromImage(image))
+            for (int mask_y = 0, e = static_cast<int>(mask.size()); mask_y < e; ++mask_y)
             {
-                std::cerr << "Error loading barrier texture from image\n";
+                const int y = top + mask_y;
+                if (y < 0 || y >= static_cast<int>(height))
+                {
+                    continue;
+                }
+
+                // Shift the row so bit 0 lands on column first_x
+                Word bits = mask[mask_y];
+                int first_x = left;
+                if (first_x < 0)
+                {
+                    bits >>= -first_x;
+                    first_x = 0;
+                }
+
+                Word *row = &solid[y * words_per_row];
+                const unsigned int word = first_x / word_bits;
+                const unsigned int shift = first_x % word_bits;
+
+                if (word < words_per_row)
+                {
+                    row[word] &= ~(bits << shift);
+                }
+
+                if (shift != 0 && word + 1 < words_per_row)
+                {
+                    row[word + 1] &= ~(bits >> (word_bits - shift));
+                }
             }
+        }
 
-            return true;
+        // Re-derives the display pixels inside area from the solidity bits
+        void refreshImage(const sf::IntRect &area)
+        {
+            const sf::Vector2u begin{area.position};
+            const sf::Vector2u end{area.position + area.size};
+
+            for (unsigned int y = begin.y; y < end.y; ++y)
+            {
+                for (unsigned int x = begin.x; x < end.x; ++x)
+                {
+                    image.setPixel({x, y},
+                                   isSolid(sf::Vector2i(sf::Vector2u{x, y}))
+                                       ? original_image->getPixel({x, y})
+                                       : sf::Color::Transparent);
+                }
+            }
         }
 
-        bool imageContainsPixel(const sf::Vector2u pixel) const
+        // Grows the dirty rectangle to cover area, clipped to the image
+        void markDirty(const sf::IntRect &area)
         {
-            if (pixel.x >= image.getSize().x || pixel.y >= image.getSize().y)
+            const sf::Vector2i image_size{original_image->getSize()};
+            sf::Vector2i min{std::max(area.position.x, 0), std::max(area.position.y, 0)};
+            sf::Vector2i max{
+                std::min(area.position.x + area.size.x, image_size.x),
+                std::min(area.position.y + area.size.y, image_size.y)
+            };
+
+            if (dirty_rect)
             {
-                return false;
+                min = {std::min(min.x, dirty_rect->position.x), std::min(min.y, dirty_rect->position.y)};
+                max = {
+                    std::max(max.x, dirty_rect->position.x + dirty_rect->size.x),
+                    std::max(max.y, dirty_rect->position.y + dirty_rect->size.y)
+                };
             }
 
-            return true;
+            dirty_rect = sf::IntRect{min, max - min};
         }
 };
 
@@ -0,0 +1,148 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "InputPolicy.h"
+#include "Simulation.h"
+#include "SpriteImages.h"
+#include "ThreadPool.h"
+
+// Plays many independent games in parallel, each driven by its own InputPolicy. Every game owns its Simulation
+// and policy, the only thing they share is the read-only sprite images.
+class BatchRunner
+{
+    const SpriteImages &images;
+    const AlienManager::Formation formation;
+    const std::string policy_name;
+    const long max_ticks;
+
+    public:
+        struct GameResult
+        {
+            int score = 0;
+            long ticks = 0;
+            int level = 1;
+            // False if the game was still running after max_ticks
+            bool game_over = false;
+        };
+
+        // Games that haven't ended after max_ticks are stopped there
+        BatchRunner(const SpriteImages &images,
+                    AlienManager::Formation formation,
+                    std::string policy_name,
+                    const long max_ticks) : images(images), formation(std::move(formation)),
+                                            policy_name(std::move(policy_name)), max_ticks(max_ticks)
+        {
+            if (!makeInputPolicy(this->policy_name, 0))
+            {
+                throw std::invalid_argument("Unknown input policy: " + this->policy_name);
+            }
+        }
+
+        // Game i is seeded with base_seed + i, so results don't depend on the number of threads
+        [[nodiscard]] std::vector<GameResult> run(const std::size_t game_count,
+                                                  const std::uint32_t base_seed,
+                                                  ThreadPool &pool) const
+        {
+            std::vector<GameResult> results(game_count);
+            for (std::size_t i = 0; i < game_count; ++i)
+            {
+                pool.submit([this, &results, i, seed = static_cast<std::uint32_t>(base_seed + i)]
+                {
+                    results[i] = play(seed);
+                });
+            }
+            pool.wait();
+
+            return results;
+        }
+
+        static void printSummary(const std::vector<GameResult> &results, std::ostream &out)
+        {
+            if (results.empty())
+            {
+                return;
+            }
+
+            std::vector<int> scores;
+            std::vector<long> ticks;
+            std::vector<int> levels;
+            std::size_t games_over = 0;
+            for (const GameResult &result : results)
+            {
+                scores.push_back(result.score);
+                ticks.push_back(result.ticks);
+                levels.push_back(result.level);
+                games_over += result.game_over;
+            }
+
+            std::sort(scores.begin(), scores.end());
+            std::sort(ticks.begin(), ticks.end());
+            std::sort(levels.begin(), levels.end());
+
+            const auto seconds = [](const long tick_count)
+            {
+                return static_cast<double>(tick_count) / Simulation::tick_rate;
+            };
+
+            out << results.size() << " game(s), " << games_over << " ended, "
+                    << results.size() - games_over << " stopped at the tick limit\n"
+                    << "score:    mean " << mean(scores) << ", p10 " << percentile(scores, 0.10)
+                    << ", median " << percentile(scores, 0.50) << ", p90 " << percentile(scores, 0.90)
+                    << ", max " << scores.back() << '\n'
+                    << "survival: mean " << seconds(static_cast<long>(mean(ticks))) << " s, p10 "
+                    << seconds(percentile(ticks, 0.10)) << " s, median " << seconds(percentile(ticks, 0.50))
+                    << " s, p90 " << seconds(percentile(ticks, 0.90)) << " s\n"
+                    << "level:    mean " << mean(levels) << ", median " << percentile(levels, 0.50)
+                    << ", max " << levels.back() << '\n';
+        }
+
+    private:
+        [[nodiscard]] GameResult play(const std::uint32_t seed) const
+        {
+            Simulation simulation{images, seed, formation};
+            const std::unique_ptr<InputPolicy> policy = makeInputPolicy(policy_name, seed);
+
+            GameResult result;
+            while (result.ticks < max_ticks && !simulation.isGameOver())
+            {
+                simulation.step(policy->nextInput(simulation));
+                ++result.ticks;
+            }
+
+            result.score = simulation.getScore();
+            result.level = simulation.getLevel();
+            result.game_over = simulation.isGameOver();
+
+            return result;
+        }
+
+        template<typename T>
+        static double mean(const std::vector<T> &values)
+        {
+            double sum = 0.0;
+            for (const T value : values)
+            {
+                sum += value;
+            }
+
+            return sum / values.size();
+        }
+
+        // values must be sorted
+        template<typename T>
+        static T percentile(const std::vector<T> &values, const double fraction)
+        {
+            return values[static_cast<std::size_t>(fraction * (values.size() - 1))];
+        }
+};
+
+#endif //BATCHRUNNER_H
@@ -1,85 +1,68 @@
 #ifndef BULLET_H
 #define BULLET_H
 
-// #include "BulletType.h"
+#include <cstdint>
+
 #include <SFML/Graphics.hpp>
 
-class Bullet final : public sf::Drawable
+// Plain bullet record, trivially copyable so BulletPool can move bullets around with plain copies
+struct Bullet final
 {
+    enum class Type : std::uint8_t
+    {
+        Player,
+        Enemy
+    };
+
+    sf::Vector2f position;
+    sf::Vector2f previous_position;
+    // Signed vertical speed, player bullets fly up
     float speed;
-    float left_x;
-    float right_x;
-
-    public:
-        enum class Type
-        {
-            Player,
-            Enemy
-        };
-
-        sf::Sprite sprite;
-
-        explicit Bullet(const sf::Texture &texture,
-                        const float speed,
-                        const sf::Vector2f &scale,
-                        const sf::Vector2f &pos,
-                        const Type bullet_type) : sprite(texture), bullet_type(bullet_type)
-        {
-            // If it's a player bullet, change the direction of movement
-            if (bullet_type == Type::Player)
-            {
-                this->speed = -speed;
-            }
-            else
-            {
-                this->speed = speed;
-            }
-
-            //Set origin to center
-            const auto textureSize = texture.getSize();
-            sprite.setOrigin({static_cast<float>(textureSize.x) / 2.0f, static_cast<float>(textureSize.y) / 2.0f});
-
-            sprite.setScale(scale);
-
-            sprite.setPosition(pos);
-
-            left_x = sprite.getOrigin().x - static_cast<float>(textureSize.x) / 2.0f + pos.x;
-            right_x = sprite.getOrigin().x + static_cast<float>(textureSize.x) / 2.0f + pos.x;
-        }
-
-        void draw(sf::RenderTarget &target, const sf::RenderStates states) const override
-        {
-            target.draw(sprite, states);
-        }
-
-        void move(const std::int32_t delta_time)
-        {
-            const float distance = speed * delta_time;
-            sprite.move({0.0f, distance});
-        }
-
-        sf::Vector2f getPosition() const
-        {
-            return sprite.getPosition();
-        }
-
-        sf::Vector2f getUpperLeft() const
-        {
-            return {left_x, sprite.getPosition().y};
-        }
-
-        sf::Vector2f getUpperRight() const
-        {
-            return {right_x, sprite.getPosition().y};
-        }
-
-        Type getBulletType() const
-        {
-            return bullet_type;
-        }
-
-    private:
-        Type bullet_type;
+    // Collision edges span hit_width from the bullet's centre to the right
+    float hit_width;
+    Type bullet_type;
+    // Set to remove the bullet at the next BulletPool::flushRemovals()
+    bool pending_removal;
+
+    static Bullet create(const sf::Vector2u &texture_size, const float speed, const sf::Vector2f &pos,
+                         const Type bullet_type)
+    {
+        // If it's a player bullet, change the direction of movement
+        const float velocity = bullet_type == Type::Player ? -speed : speed;
+        return Bullet{pos, pos, velocity, static_cast<float>(texture_size.x), bullet_type, false};
+    }
+
+    void move(const float delta_time)
+    {
+        previous_position = position;
+        position.y += speed * delta_time;
+    }
+
+    [[nodiscard]] sf::Vector2f getPosition() const
+    {
+        return position;
+    }
+
+    // Position between the previous and the current step, alpha in [0, 1]
+    [[nodiscard]] sf::Vector2f getInterpolatedPosition(const float alpha) const
+    {
+        return previous_position + (position - previous_position) * alpha;
+    }
+
+    [[nodiscard]] sf::Vector2f getUpperLeft() const
+    {
+        return position;
+    }
+
+    [[nodiscard]] sf::Vector2f getUpperRight() const
+    {
+        return {position.x + hit_width, position.y};
+    }
+
+    [[nodiscard]] Type getBulletType() const
+    {
+        return bullet_type;
+    }
 };
 
 #endif //BULLET_H
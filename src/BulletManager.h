@@ -2,51 +2,56 @@
 #define BULLETMANAGER_H
 
 #include <iostream>
-#include <vector>
+#include <optional>
 
 #include <SFML/Graphics.hpp>
 
 #include "Bullet.h"
+#include "BulletPool.h"
+#include "Profiler.h"
 
-class BulletManager final : public sf::Drawable
+class BulletManager final
 {
-    const sf::Texture texture;
+    const sf::Vector2u texture_size;
 
     const int min_height;
     const int max_height;
     const float player_bullet_speed;
     const float enemy_bullet_speed;
-    const sf::Vector2f &bullet_scale;
 
     public:
-        std::vector<Bullet> alien_bullets{};
+        BulletPool alien_bullets;
         std::optional<Bullet> player_bullet{};
 
-        explicit BulletManager(const std::filesystem::path &filename,
+        // max_alien_bullets is how many alien bullets may be in flight at once, all preallocated
+        explicit BulletManager(const sf::Vector2u &texture_size,
                                const int min_height,
                                const int max_height,
                                const float bullet_speed,
                                const float enemy_bullet_speed,
-                               const sf::Vector2f &bullet_scale) : texture(filename), min_height(min_height),
-                                                                   max_height(max_height),
-                                                                   player_bullet_speed(bullet_speed),
-                                                                   enemy_bullet_speed(enemy_bullet_speed),
-                                                                   bullet_scale(bullet_scale)
+                               const std::size_t max_alien_bullets) : texture_size(texture_size),
+                                                                      min_height(min_height),
+                                                                      max_height(max_height),
+                                                                      player_bullet_speed(bullet_speed),
+                                                                      enemy_bullet_speed(enemy_bullet_speed),
+                                                                      alien_bullets(max_alien_bullets)
         {
         }
 
-        void move(const std::int32_t delta_time)
+        void move(const float delta_time)
         {
+            PROFILE_ZONE("Bullets");
+
             for (std::size_t i = 0, e = alien_bullets.size(); i < e; ++i)
             {
                 alien_bullets[i].move(delta_time);
-                // std::cout<<"("<<bullets[i].getPosition().x << ", " << bullets[i].getPosition().y << ")\n";
 
                 if (isOutOfBounds(alien_bullets[i]))
                 {
-                    alien_bullets.erase(alien_bullets.begin() + i);
+                    alien_bullets.markForRemoval(i);
                 }
             }
+            alien_bullets.flushRemovals();
 
             if (player_bullet)
             {
@@ -58,19 +63,6 @@ class BulletManager final : public sf::Drawable
             }
         }
 
-        void draw(sf::RenderTarget &target, const sf::RenderStates states) const override
-        {
-            for (auto &&bullet : alien_bullets)
-            {
-                bullet.draw(target, states);
-            }
-
-            if (player_bullet)
-            {
-                player_bullet->draw(target, states);
-            }
-        }
-
         // Returns true if a bullet was added
         bool addBullet(const sf::Vector2f &pos, const Bullet::Type bullet_type)
         {
@@ -85,12 +77,7 @@ class BulletManager final : public sf::Drawable
                     break;
 
                 case Bullet::Type::Enemy:
-                    if (canEntityShoot())
-                    {
-                        alien_bullets.emplace_back(createBullet(pos, enemy_bullet_speed, bullet_type));
-                        return true;
-                    }
-                    break;
+                    return alien_bullets.spawn(createBullet(pos, enemy_bullet_speed, bullet_type));
             }
 
             return false;
@@ -101,9 +88,15 @@ class BulletManager final : public sf::Drawable
             player_bullet.reset();
         }
 
-        void eraseAlienBullet(const int index)
+        // Removed at the next flushAlienBullets()
+        void eraseAlienBullet(const std::size_t index)
+        {
+            alien_bullets.markForRemoval(index);
+        }
+
+        void flushAlienBullets()
         {
-            alien_bullets.erase(alien_bullets.begin() + index);
+            alien_bullets.flushRemovals();
         }
 
         void restart()
@@ -113,13 +106,6 @@ class BulletManager final : public sf::Drawable
         }
 
     private:
-        static constexpr int max_bullets_allowed = 10;
-
-        bool canEntityShoot() const
-        {
-            return alien_bullets.size() < max_bullets_allowed;
-        }
-
         [[nodiscard]] bool isOutOfBounds(const Bullet &bullet) const
         {
             const int pos_y = static_cast<int>(bullet.getPosition().y);
@@ -131,7 +117,7 @@ class BulletManager final : public sf::Drawable
                                           const float speed,
                                           const Bullet::Type bullet_type) const
         {
-            return Bullet(texture, speed, bullet_scale, pos, bullet_type);
+            return Bullet::create(texture_size, speed, pos, bullet_type);
         }
 };
 
@@ -0,0 +1,100 @@
+#ifndef BULLETPOOL_H
+#define BULLETPOOL_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "Bullet.h"
+
+// Fixed-capacity storage for live bullets. All memory is allocated up front, spawning appends and removal
+// swaps the last live bullet into the hole, so neither ever allocates or shifts the other bullets.
+// Removal is deferred: mark bullets while iterating and call flushRemovals() once the iteration is done.
+class BulletPool
+{
+    static_assert(std::is_trivially_copyable_v<Bullet>);
+
+    std::vector<Bullet> bullets;
+    std::size_t live_count = 0;
+
+    public:
+        explicit BulletPool(const std::size_t capacity) : bullets(capacity)
+        {
+        }
+
+        // Returns false if the pool is full
+        bool spawn(const Bullet &bullet)
+        {
+            if (live_count == bullets.size())
+            {
+                return false;
+            }
+
+            bullets[live_count++] = bullet;
+            return true;
+        }
+
+        // Safe to call while iterating, the bullet stays in place until flushRemovals()
+        void markForRemoval(const std::size_t index)
+        {
+            bullets[index].pending_removal = true;
+        }
+
+        // Swaps every marked bullet with the last live one and shrinks the live range
+        void flushRemovals()
+        {
+            for (std::size_t i = 0; i < live_count;)
+            {
+                if (bullets[i].pending_removal)
+                {
+                    bullets[i] = bullets[--live_count];
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+        void clear()
+        {
+            live_count = 0;
+        }
+
+        [[nodiscard]] std::size_t size() const
+        {
+            return live_count;
+        }
+
+        [[nodiscard]] std::size_t capacity() const
+        {
+            return bullets.size();
+        }
+
+        [[nodiscard]] bool full() const
+        {
+            return live_count == bullets.size();
+        }
+
+        Bullet &operator[](const std::size_t index)
+        {
+            return bullets[index];
+        }
+
+        const Bullet &operator[](const std::size_t index) const
+        {
+            return bullets[index];
+        }
+
+        [[nodiscard]] const Bullet *begin() const
+        {
+            return bullets.data();
+        }
+
+        [[nodiscard]] const Bullet *end() const
+        {
+            return bullets.data() + live_count;
+        }
+};
+
+#endif //BULLETPOOL_H
@@ -0,0 +1,50 @@
+#ifndef FIXEDTIMESTEP_H
+#define FIXEDTIMESTEP_H
+
+#include <algorithm>
+
+#include <SFML/System.hpp>
+
+// Turns variable frame times into a whole number of fixed simulation ticks.
+// Leftover time is carried over to the next frame and exposed as an interpolation factor for rendering.
+class FixedTimestep
+{
+    const sf::Time tick;
+    const sf::Time max_frame_time;
+    sf::Time accumulator = sf::Time::Zero;
+
+    public:
+        // Frames longer than max_frame_time (hitches, breakpoints) are clamped so they don't move everything at once
+        explicit FixedTimestep(const sf::Time tick, const sf::Time max_frame_time) : tick(tick),
+            max_frame_time(max_frame_time)
+        {
+        }
+
+        // Adds the real time that passed since the last frame. Returns how many ticks to simulate now.
+        unsigned int advance(const sf::Time frame_time)
+        {
+            accumulator += std::min(frame_time, max_frame_time);
+
+            unsigned int ticks = 0;
+            while (accumulator >= tick)
+            {
+                accumulator -= tick;
+                ++ticks;
+            }
+
+            return ticks;
+        }
+
+        // How far rendering is between the last simulated tick and the next one, in [0, 1)
+        [[nodiscard]] float getAlpha() const
+        {
+            return accumulator / tick;
+        }
+
+        void reset()
+        {
+            accumulator = sf::Time::Zero;
+        }
+};
+
+#endif //FIXEDTIMESTEP_H
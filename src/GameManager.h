@@ -1,342 +1,1045 @@
 #ifndef GAMEMANAGER_H
 #define GAMEMANAGER_H
 
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
 #include <SFML/Graphics.hpp>
 #include <string>
+#include <thread>
+#include <utility>
 
-#include "AlienManager.h"
-#include "Barrier.h"
+#include "AssetLoader.h"
+#include "AudioService.h"
+#include "FixedTimestep.h"
+#include "HighScoreFile.h"
+#include "Hud.h"
+#include "InputQueue.h"
+#include "LatencyHistogram.h"
 #include "Menu.h"
-#include "Spaceship.h"
+#include "Profiler.h"
+#include "RenderSnapshot.h"
+#include "Replay.h"
+#include "ResourceRegistry.h"
+#include "Simulation.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+#include "TripleBuffer.h"
 
 class GameManager
 {
-    static constexpr int window_x = 1920;
-    static constexpr int window_y = 1080;
+    static constexpr int window_x = Simulation::world_x;
+    static constexpr int window_y = Simulation::world_y;
     static constexpr int framerate_limit = 144;
+    // While another window has focus the game keeps running but only needs to be drawn now and then
+    static constexpr int background_framerate_limit = 10;
+    // Longest wait for an event while a menu is open and the game stands still
+    static constexpr sf::Time menu_wait_timeout = sf::milliseconds(100);
+    static constexpr sf::Time tick = sf::microseconds(1'000'000 / Simulation::tick_rate);
+    static constexpr sf::Time max_frame_time = sf::milliseconds(250);
+
+    // Measures the startup, reported once the first frame is on screen
+    sf::Clock startup_clock;
+    const std::filesystem::path asset_root = AssetLoader::findRoot();
+    // Assets are read from the pack when the build made one, else decoded from the files below asset_root
+    const std::optional<AssetPack> asset_pack = AssetPack::open(AssetLoader::findPack());
+
+    // Every asset is loaded once and shared through handles, F5 prints what's resident
+    ResourceRegistry resources;
+
+    // Filled in by the asset loader
+    ResourceHandle<sf::Font> font;
+    SpriteImages images;
+
+    // Every sprite lives in one atlas texture, so the whole world is drawn from a single batch layer
+    TextureAtlas atlas;
+    std::array<std::array<TextureAtlas::Handle, 2>, 3> alien_regions{};
+    TextureAtlas::Handle explosion_region{};
+    TextureAtlas::Handle bullet_region{};
+    TextureAtlas::Handle spaceship_region{};
+
+    // Each barrier has its own atlas region. When a snapshot brings a newer revision of its image, only the areas
+    // changed since the uploaded revision are uploaded.
+    std::array<TextureAtlas::Handle, Simulation::barrier_count> barrier_regions{};
+    std::array<std::uint64_t, Simulation::barrier_count> uploaded_barrier_revisions{};
+
+    AudioService audio;
+    AudioService::Handle shoot_sound{};
+    AudioService::Handle explosion_sound{};
+    AudioService::Handle alien_killed_sound{};
+    std::array<AudioService::Handle, 4> alien_move_sounds{};
+    unsigned int current_sound_index = 0;
+
+    // Starts decoding before the window is created, so the two overlap
+    AssetLoader asset_loader{asset_root, asset_pack ? &*asset_pack : nullptr};
+    std::size_t images_pending = 0;
+    const bool assets_requested = requestAssets();
 
     sf::RenderWindow window{
         sf::VideoMode({window_x, window_y}), "Space Invaders", sf::Style::Titlebar | sf::Style::Close
     };
 
-    const sf::Font font{"../../assets/fonts/arial.ttf"};
+    // Everything below needs the assets
+    const sf::Time assets_ready_time = finishLoading();
+
     Menu menu{font};
 
-    sf::Text player_lives_text{font, "Lives: ", 36};
-    sf::Text player_score_text{font, "Score: ", 36};
-    sf::Text high_score_text{font, "High Score : ", 36};
+    Hud hud{font, 36, sf::Color::Green};
+    const std::size_t lives_counter = hud.addCounter("Lives: ", {0.92f * window_x, 0.0f});
+    const std::size_t score_counter = hud.addCounter("Score: ", {0.05f, 0.0f});
+    const std::size_t high_score_counter = hud.addCounter("High Score: ", {0.40f * window_x, 0.0f});
 
-    static constexpr float player_bullet_speed = 1.2f;
-    static constexpr float enemy_bullet_speed = 0.5f;
-    static constexpr sf::Vector2f bullet_scale = {5.0f, 12.5f};
-    BulletManager bullet_manager{
-        "../../assets/images/bullet.png", 0, window_y, player_bullet_speed, enemy_bullet_speed, bullet_scale
-    };
+    // Per-phase frame times, toggled with F3 in builds with the profiler enabled
+    sf::Text profiler_text{*font, "", 20};
+    bool show_profiler = false;
+    static constexpr unsigned int profiler_refresh_frames = 30;
+    unsigned int frames_since_profiler_refresh = 0;
 
-    static constexpr float spaceship_speed = 0.8f;
-    static constexpr float spaceship_scale = 4.0f;
-    static constexpr sf::Vector2f spaceship_pos = {window_x / 2.0f, window_y - 0.1f * window_y};
-    Spaceship spaceship{
-        "../../assets/images/spaceship.png", spaceship_speed, spaceship_scale, spaceship_pos, 0.0f, window_x
-    };
+    SpriteBatch sprite_batch;
 
-    static constexpr int alien_move_interval = 500;
-    static constexpr float alien_speed = 5.0f;
-    static constexpr float alien_step_down = 5.0f;
-    static constexpr float alien_scale = 3.0f;
-    static constexpr int aliens_row = 5;
-    static constexpr int aliens_col = 10;
-    const std::vector<AlienManager::TwoTextures> alien_textures = {
-        {"../../assets/images/alien3a.png", "../../assets/images/alien3b.png"},
-        {"../../assets/images/alien2a.png", "../../assets/images/alien2b.png"},
-        {"../../assets/images/alien1a.png", "../../assets/images/alien1b.png"}
-    };
-    const sf::Texture explosion_texture{"../../assets/images/alienExplosion.png"};
-    AlienManager alien_manager{
-        alien_textures, explosion_texture, {0.05f * window_x, 0.1f * window_y}, {0.95f * window_x, 0.7f * window_y},
-        alien_speed, alien_move_interval, alien_step_down, alien_scale
+    Simulation simulation;
+
+    // The game in progress, written to replay_path when it ends so it can be played back with --replay
+    Replay replay;
+    const std::filesystem::path replay_path{"last_game.replay"};
+
+    // Everything that stops the game for a while is a state of the main loop, which keeps handling events,
+    // playing sounds and drawing frames throughout
+    enum class State : std::uint8_t
+    {
+        Playing,
+        // The player was just hit, the game holds still for a moment
+        HitPause,
+        // The main menu is open
+        Paused,
+        GameOver,
+        // A level was cleared, its number is shown before the next one starts
+        LevelTransition
     };
 
-    static constexpr float barrier_scale = 8.0f;
-    Barrier barrier1{"../../assets/images/barrier.png", barrier_scale, {0.15f * window_x, 0.65f * window_y}};
-    Barrier barrier2{"../../assets/images/barrier.png", barrier_scale, {0.35f * window_x, 0.65f * window_y}};
-    Barrier barrier3{"../../assets/images/barrier.png", barrier_scale, {0.55f * window_x, 0.65f * window_y}};
-    Barrier barrier4{"../../assets/images/barrier.png", barrier_scale, {0.75f * window_x, 0.65f * window_y}};
+    static constexpr sf::Time hit_pause_time = sf::seconds(1);
+    static constexpr sf::Time level_transition_time = sf::seconds(2);
+    // Events after which the simulation thread stops itself for a timed state
+    static constexpr unsigned int stopping_events = Simulation::PlayerHit | Simulation::LevelCleared;
+
+    State state = State::Playing;
+    // What the main menu returns to
+    State state_before_pause = State::Playing;
+    // Left of HitPause or LevelTransition, it only runs out while the state is current
+    sf::Time state_time_left = sf::Time::Zero;
+    sf::Text level_text{*font, "", 48};
+
+    bool focused = true;
 
-    int score = 0;
+    // -1 until the file is read
     int high_score = -1;
-    const std::filesystem::path high_score_path{"../../assets/high_score.txt"};
+    HighScoreFile high_score_file{asset_root / "high_score.txt"};
+
+    // The simulation runs on its own thread, so slow frames or display() waiting for vsync don't hold up ticks.
+    // After every batch of ticks it publishes a snapshot, the main thread always draws the newest one.
+    TripleBuffer<RenderSnapshot> snapshots;
+    // Every change of a barrier's image, on the simulation side
+    std::array<RenderSnapshot::BarrierDamage, Simulation::barrier_count> barrier_damage{};
+
+    // Input events from the main thread, applied at the tick they belong to
+    InputQueue input_queue;
+    // The directions the main thread last queued as held
+    bool left_down = false;
+    bool right_down = false;
+    // Sequence number and timestamp of the queued events not yet shown on screen, oldest first
+    std::deque<std::pair<std::uint64_t, InputQueue::Clock::time_point>> unpresented_inputs{};
+    // The last input event applied by the simulation thread, passed on in the snapshots
+    std::uint64_t applied_input_sequence = 0;
+    // From receiving an input event to the tick applying it, and to the first frame showing that tick.
+    // Printed when the game closes and shown in the profiler overlay.
+    LatencyHistogram input_to_tick_latency;
+    LatencyHistogram input_to_present_latency;
+    // Events of the ticks since the main thread last played sounds
+    std::atomic<unsigned int> pending_events{Simulation::None};
+
+    std::mutex simulation_mutex;
+    std::condition_variable simulation_state_changed;
+    // Polled between ticks, guarded by simulation_mutex when waiting on it
+    std::atomic<bool> pause_requested{false};
+    bool simulation_paused = false;
+    bool stopping = false;
+    // Joined by stopSimulation(), at the latest when the game is destroyed
+    std::thread simulation_thread;
 
     public:
-        GameManager()
+        // A muted game never opens an audio device
+        explicit GameManager(const AlienManager::Formation &formation = AlienManager::Formation::make(),
+                             const bool muted = false) : GameManager(formation, std::random_device{}(), muted)
+        {
+        }
+
+        GameManager(const AlienManager::Formation &formation, const std::uint32_t seed, const bool muted) :
+            audio{AudioService::create(muted)}, simulation{images, seed, formation}, replay{seed, formation}
         {
             window.setFramerateLimit(framerate_limit);
 
-            player_lives_text.setFillColor(sf::Color::Green);
-            player_lives_text.setStyle(sf::Text::Bold);
-            player_lives_text.setPosition({0.92f * window_x, 0.0f});
+            profiler_text.setFillColor(sf::Color::Yellow);
+            profiler_text.setPosition({0.05f, 50.0f});
 
-            player_score_text.setFillColor(sf::Color::Green);
-            player_score_text.setStyle(sf::Text::Bold);
-            player_score_text.setPosition({0.05f, 0.0f});
+            level_text.setFillColor(sf::Color::Green);
+            level_text.setStyle(sf::Text::Bold);
+            level_text.setPosition({window_x / 2.0f, window_y / 2.0f});
+        }
 
-            high_score_text.setFillColor(sf::Color::Green);
-            high_score_text.setStyle(sf::Text::Bold);
-            high_score_text.setPosition({0.40f * window_x, 0.0f});
+        ~GameManager()
+        {
+            stopSimulation();
         }
 
         void run()
         {
-            high_score = loadHighScore(high_score_path);
-            high_score_text.setString("High Score: " + std::to_string(high_score));
+            high_score_file.load();
+
+            startSimulation();
+
+            sf::Clock frame_clock;
+            bool first_frame = true;
 
-            sf::Clock clock;
             while (window.isOpen())
             {
-                const std::int32_t delta_time = clock.restart().asMilliseconds();
-
-                // Process events
-                while (const std::optional event = window.pollEvent())
+                // A menu only changes on input, so while one is open and the simulation has nothing left to report
+                // the loop sleeps until an event comes in instead of drawing the same screen at the full framerate
+                if (menu.isOpen() && pending_events == Simulation::None)
                 {
-                    if (event->is<sf::Event::Closed>())
+                    if (const std::optional event = window.waitEvent(menu_wait_timeout))
                     {
-                        saveHighScore(high_score_path);
-                        window.close();
-                    }
-                    else if (const auto *key_pressed = event->getIf<sf::Event::KeyPressed>())
-                    {
-                        if (key_pressed->scancode == sf::Keyboard::Scan::Escape)
-                        {
-                            clock.stop();
-                            switch (menu.openMainMenu(window))
-                            {
-                                case Menu::MenuResult::Restart:
-                                    restart();
-                                    break;
-
-                                case Menu::MenuResult::ClearHighScore:
-                                    clearHighScore(high_score_path);
-                                    high_score_text.setString("High Score: " + std::to_string(high_score));
-                                    break;
-
-                                case Menu::MenuResult::Exit:
-                                    saveHighScore(high_score_path);
-                                    window.close();
-                                    break;
-
-                                default: break;
-                            }
-
-                            clock.start();
-                        }
-                        else if (key_pressed->scancode == sf::Keyboard::Scan::Space)
-                        {
-                            spaceship.shoot(bullet_manager);
-                        }
+                        handleEvent(*event);
                     }
+                    // The wait isn't frame time, a timed state resumed from the menu continues where it stopped
+                    frame_clock.restart();
                 }
 
-                if (alien_manager.allAliensDead())
+                const sf::Time frame_time = frame_clock.restart();
+
+                // Process events
+                while (const std::optional event = window.pollEvent())
                 {
-                    nextLevel();
+                    handleEvent(*event);
                 }
 
-                if (isKeyPressed(sf::Keyboard::Scan::Left))
+                if (const std::optional<int> loaded = high_score_file.takeLoaded())
                 {
-                    spaceship.move_left(delta_time);
+                    high_score = std::max(high_score, *loaded);
+                    hud.setValue(high_score_counter, high_score);
                 }
 
-                if (isKeyPressed(sf::Keyboard::Scan::Right))
+                snapshots.update();
+                update(frame_time);
+
+                // An open menu is drawn again only when it changed
+                if (menu.isOpen() && !menu.takeChanged())
                 {
-                    spaceship.move_right(delta_time);
+                    continue;
                 }
 
-                alien_manager.update(delta_time, bullet_manager);
-                bullet_manager.move(delta_time);
-
-                const bool was_player_hit = handleCollisions();
+                // Transitions may have published a snapshot of their own
+                const RenderSnapshot &snapshot = snapshots.getFront();
 
                 // Clear screen
                 window.clear();
 
-                // Draw the sprites
-                window.draw(spaceship);
-                window.draw(bullet_manager);
-                window.draw(alien_manager);
-                window.draw(barrier1);
-                window.draw(barrier2);
-                window.draw(barrier3);
-                window.draw(barrier4);
-
-                // Draw text
-                player_lives_text.setString("Lives: " + std::to_string(spaceship.getLives()));
-                window.draw(player_lives_text);
+                if (menu.isOpen())
+                {
+                    menu.draw(window);
+                }
+                else
+                {
+                    // Draw the sprites
+                    drawWorld(snapshot);
 
-                player_score_text.setString("Score: " + std::to_string(score));
-                window.draw(player_score_text);
+                    // Draw text
+                    drawHud(snapshot);
 
-                window.draw(high_score_text);
+                    if (state == State::LevelTransition)
+                    {
+                        window.draw(level_text);
+                    }
+                }
 
                 // Update the window
-                window.display();
+                {
+                    PROFILE_ZONE("Display");
+                    window.display();
+                }
+                recordPresentedInputs(snapshot);
 
-                if (was_player_hit)
+                if (first_frame)
                 {
-                    clock.stop();
-                    sf::sleep(sf::seconds(1));
-                    clock.start();
+                    first_frame = false;
+                    std::cout << "Assets ready after " << assets_ready_time.asMilliseconds()
+                            << " ms, first frame after " << startup_clock.getElapsedTime().asMilliseconds() << " ms\n";
                 }
 
-                if (spaceship.isDead())
+                if constexpr (Profiler::enabled)
                 {
-                    clock.stop();
-                    saveHighScore(high_score_path);
-                    switch (menu.openGameOverScreen(window, score))
-                    {
-                        case Menu::MenuResult::Restart:
-                            restart();
-                            break;
+                    Profiler::instance().endFrame();
+                }
+            }
 
-                        default:
-                            window.close();
-                            break;
-                    }
+            stopSimulation();
+            submitHighScore();
+            saveReplay();
+            high_score_file.flush();
 
-                    clock.start();
-                }
+            if (input_to_tick_latency.getCount() != 0)
+            {
+                std::cout << formatLatencyStats();
             }
         }
 
     private:
-        // Returns true if player was hit
-        bool handleCollisions()
+        void handleEvent(const sf::Event &event)
         {
-            bool was_player_hit = false;
-            if (const auto &player_bullet = bullet_manager.player_bullet)
+            if (event.is<sf::Event::Closed>())
             {
-                if (const int value = alien_manager.handleCollision(player_bullet.value()); value != 0)
+                window.close();
+            }
+            else if (event.is<sf::Event::FocusLost>())
+            {
+                setFocused(false);
+            }
+            else if (event.is<sf::Event::FocusGained>())
+            {
+                setFocused(true);
+                menu.invalidate();
+            }
+            else if (event.is<sf::Event::Resized>())
+            {
+                menu.invalidate();
+            }
+            else if (const auto *key_released = event.getIf<sf::Event::KeyReleased>())
+            {
+                if (key_released->scancode == sf::Keyboard::Scan::Left)
+                {
+                    setHeld(left_down, false, InputQueue::Action::LeftPressed, InputQueue::Action::LeftReleased);
+                }
+                else if (key_released->scancode == sf::Keyboard::Scan::Right)
+                {
+                    setHeld(right_down, false, InputQueue::Action::RightPressed, InputQueue::Action::RightReleased);
+                }
+            }
+            else if (menu.isOpen())
+            {
+                if (const std::optional<Menu::MenuResult> result = menu.handleEvent(event))
+                {
+                    onMenuResult(*result);
+                }
+            }
+            else if (const auto *key_pressed = event.getIf<sf::Event::KeyPressed>())
+            {
+                if (key_pressed->scancode == sf::Keyboard::Scan::Left)
+                {
+                    setHeld(left_down, true, InputQueue::Action::LeftPressed, InputQueue::Action::LeftReleased);
+                }
+                else if (key_pressed->scancode == sf::Keyboard::Scan::Right)
+                {
+                    setHeld(right_down, true, InputQueue::Action::RightPressed, InputQueue::Action::RightReleased);
+                }
+                else if (key_pressed->scancode == sf::Keyboard::Scan::Escape)
+                {
+                    pause();
+                }
+                else if (key_pressed->scancode == sf::Keyboard::Scan::Space)
                 {
-                    bullet_manager.erasePlayerBullet();
-                    score += value;
+                    pushInput(InputQueue::Action::Shoot);
                 }
-                else if (barrier1.handleCollision(player_bullet.value()))
+                else if (Profiler::enabled && key_pressed->scancode == sf::Keyboard::Scan::F3)
                 {
-                    bullet_manager.erasePlayerBullet();
+                    show_profiler = !show_profiler;
+                    frames_since_profiler_refresh = profiler_refresh_frames;
                 }
-                else if (barrier2.handleCollision(player_bullet.value()))
+                else if (Profiler::enabled && key_pressed->scancode == sf::Keyboard::Scan::F4)
                 {
-                    bullet_manager.erasePlayerBullet();
+                    if (!Profiler::instance().writeChromeTrace("profile_trace.json"))
+                    {
+                        std::cerr << "Error writing profile_trace.json\n";
+                    }
                 }
-                else if (barrier3.handleCollision(player_bullet.value()))
+                else if (key_pressed->scancode == sf::Keyboard::Scan::F5)
                 {
-                    bullet_manager.erasePlayerBullet();
+                    resources.report(std::cout);
                 }
-                else if (barrier4.handleCollision(player_bullet.value()))
+            }
+        }
+
+        // Plays the sounds of the ticks since the last frame and moves the state machine along
+        void update(const sf::Time frame_time)
+        {
+            const unsigned int events = pending_events.exchange(Simulation::None);
+            playSounds(events);
+
+            // The simulation thread has stopped itself after these
+            if (events & Simulation::PlayerHit)
+            {
+                startTimedState(State::HitPause, hit_pause_time);
+            }
+            else if (events & Simulation::LevelCleared)
+            {
+                startTimedState(State::LevelTransition, level_transition_time);
+            }
+
+            switch (state)
+            {
+                case State::Playing:
+                    // The simulation thread stops by itself once the game is over
+                    if (snapshots.getFront().game_over)
+                    {
+                        gameOver();
+                    }
+                    break;
+
+                case State::HitPause:
+                case State::LevelTransition:
+                    state_time_left -= frame_time;
+                    if (state_time_left <= sf::Time::Zero)
+                    {
+                        play();
+                    }
+                    break;
+
+                default: break;
+            }
+        }
+
+        // Holds the game still for duration, or after the menu if it's open. The simulation thread must have
+        // stopped itself.
+        void startTimedState(const State timed_state, const sf::Time duration)
+        {
+            pauseSimulation();
+            (state == State::Paused ? state_before_pause : state) = timed_state;
+            state_time_left = duration;
+
+            if (timed_state == State::LevelTransition)
+            {
+                level_text.setString("Level " + std::to_string(simulation.getLevel()));
+                const sf::FloatRect bounds = level_text.getLocalBounds();
+                level_text.setOrigin(bounds.position + bounds.size / 2.0f);
+            }
+        }
+
+        // Lets the simulation run again, unless the game ended meanwhile
+        void play()
+        {
+            if (simulation.isGameOver())
+            {
+                gameOver();
+                return;
+            }
+
+            // Input received while the simulation was stopped applies from now on, the stop isn't latency
+            const InputQueue::Clock::time_point now = InputQueue::Clock::now();
+            input_queue.delayTo(now);
+            for (auto &[sequence, time] : unpresented_inputs)
+            {
+                if (sequence > applied_input_sequence)
                 {
-                    bullet_manager.erasePlayerBullet();
+                    time = std::max(time, now);
                 }
             }
 
-            for (size_t i = 0, e = bullet_manager.alien_bullets.size(); i < e; ++i)
+            state = State::Playing;
+            resumeSimulation();
+        }
+
+        // Opens the main menu, the state the game was in continues when it's closed
+        void pause()
+        {
+            pauseSimulation();
+            state_before_pause = state;
+            state = State::Paused;
+            menu.openMainMenu(window);
+        }
+
+        void gameOver()
+        {
+            pauseSimulation();
+            state = State::GameOver;
+            submitHighScore();
+            menu.openGameOverScreen(window, simulation.getScore());
+        }
+
+        void onMenuResult(const Menu::MenuResult result)
+        {
+            switch (result)
+            {
+                case Menu::MenuResult::Resume:
+                    resume();
+                    break;
+
+                case Menu::MenuResult::Restart:
+                    restart();
+                    play();
+                    break;
+
+                case Menu::MenuResult::ClearHighScore:
+                    high_score = 0;
+                    hud.setValue(high_score_counter, high_score);
+                    high_score_file.clear();
+                    resume();
+                    break;
+
+                case Menu::MenuResult::Exit:
+                    window.close();
+                    break;
+            }
+
+            // Keys pressed or released while the menu was open went to the menu
+            syncHeldKeys();
+        }
+
+        // Back to the state the menu was opened from
+        void resume()
+        {
+            if (state_before_pause == State::Playing)
+            {
+                play();
+            }
+            else
+            {
+                state = state_before_pause;
+            }
+        }
+
+        // Unfocused frames are limited to background_framerate_limit, display() then sleeps out the rest of the
+        // frame. The fixed timestep still runs every tick that passed.
+        void setFocused(const bool has_focus)
+        {
+            if (focused != has_focus)
+            {
+                focused = has_focus;
+                window.setFramerateLimit(focused ? framerate_limit : background_framerate_limit);
+                syncHeldKeys();
+            }
+        }
+
+        // Queues an input event for the simulation thread, stamped with the time it's received
+        void pushInput(const InputQueue::Action action)
+        {
+            const InputQueue::Clock::time_point time = InputQueue::Clock::now();
+            unpresented_inputs.emplace_back(input_queue.push(action, time), time);
+        }
+
+        // Queues pressed or released if held changes, key repeats and duplicate releases aren't passed on
+        void setHeld(bool &held, const bool now_held, const InputQueue::Action pressed,
+                     const InputQueue::Action released)
+        {
+            if (held != now_held)
+            {
+                held = now_held;
+                pushInput(now_held ? pressed : released);
+            }
+        }
+
+        // Brings the held directions in line with the keyboard, after menus or other windows took the key events.
+        // The keyboard state is global, keys held for another window mustn't steer the ship.
+        void syncHeldKeys()
+        {
+            setHeld(left_down, focused && isKeyPressed(sf::Keyboard::Scan::Left),
+                    InputQueue::Action::LeftPressed, InputQueue::Action::LeftReleased);
+            setHeld(right_down, focused && isKeyPressed(sf::Keyboard::Scan::Right),
+                    InputQueue::Action::RightPressed, InputQueue::Action::RightReleased);
+        }
+
+        // The snapshot just displayed shows the effect of every input its ticks applied
+        void recordPresentedInputs(const RenderSnapshot &snapshot)
+        {
+            const InputQueue::Clock::time_point now = InputQueue::Clock::now();
+            while (!unpresented_inputs.empty() && unpresented_inputs.front().first <= snapshot.input_sequence)
+            {
+                input_to_present_latency.record(now - unpresented_inputs.front().second);
+                unpresented_inputs.pop_front();
+            }
+        }
+
+        void startSimulation()
+        {
+            publishSnapshot();
+            snapshots.update();
+            simulation_thread = std::thread{[this]
+            {
+                simulate();
+            }};
+        }
+
+        void stopSimulation()
+        {
+            if (!simulation_thread.joinable())
+            {
+                return;
+            }
+
+            {
+                const std::lock_guard lock{simulation_mutex};
+                stopping = true;
+                // Also gets the thread out of its tick loop
+                pause_requested = true;
+            }
+            simulation_state_changed.notify_all();
+            simulation_thread.join();
+        }
+
+        // Blocks until the simulation thread is parked between ticks, it stays there until resumeSimulation().
+        // Only then may the main thread touch simulation, replay or the snapshots' writer side.
+        void pauseSimulation()
+        {
+            std::unique_lock lock{simulation_mutex};
+            pause_requested = true;
+            simulation_state_changed.wait(lock, [this]
+            {
+                return simulation_paused;
+            });
+        }
+
+        void resumeSimulation()
+        {
+            {
+                const std::lock_guard lock{simulation_mutex};
+                pause_requested = false;
+                simulation_paused = false;
+            }
+            simulation_state_changed.notify_all();
+        }
+
+        // The simulation thread: steps the simulation at the tick rate and publishes a snapshot after every batch
+        // of ticks, independently of how long the main thread takes to draw and display a frame
+        void simulate()
+        {
+            sf::Clock clock;
+            FixedTimestep timestep{tick, max_frame_time};
+
+            while (true)
             {
-                if (spaceship.handleCollision(bullet_manager.alien_bullets[i]))
+                if (pause_requested)
                 {
-                    bullet_manager.eraseAlienBullet(i);
+                    if (!waitWhilePaused())
+                    {
+                        return;
+                    }
 
-                    was_player_hit = true;
+                    // The paused time isn't simulated
+                    clock.restart();
+                    timestep.reset();
+                    continue;
                 }
-                else if (barrier1.handleCollision(bullet_manager.alien_bullets[i]))
+
+                const unsigned int ticks = timestep.advance(clock.restart());
+
+                // The ticks of this batch ended a tick apart, the last one as long ago as the timestep carries over
+                const std::chrono::microseconds tick_length{tick.asMicroseconds()};
+                const std::chrono::microseconds carried_over{(tick * timestep.getAlpha()).asMicroseconds()};
+                InputQueue::Clock::time_point tick_end = InputQueue::Clock::now() - carried_over - tick_length * ticks;
+
+                unsigned int events = Simulation::None;
+                for (unsigned int i = 0; i < ticks && !(events & stopping_events); ++i)
                 {
-                    bullet_manager.eraseAlienBullet(i);
+                    PROFILE_ZONE("Simulation");
+                    tick_end += tick_length;
+                    const Input input = input_queue.takeTick(tick_end, [this](const InputQueue::Event &event)
+                    {
+                        input_to_tick_latency.record(InputQueue::Clock::now() - event.time);
+                        applied_input_sequence = event.sequence;
+                    });
+                    replay.record(input);
+                    events |= simulation.step(input);
                 }
-                else if (barrier2.handleCollision(bullet_manager.alien_bullets[i]))
+
+                // The main thread holds the game still for a while after these, or for good once it's over.
+                // Requested before the main thread can see the events, so its resumeSimulation() can't come first.
+                if (events & stopping_events || simulation.isGameOver())
                 {
-                    bullet_manager.eraseAlienBullet(i);
+                    pause_requested = true;
                 }
-                else if (barrier3.handleCollision(bullet_manager.alien_bullets[i]))
+
+                if (ticks != 0)
                 {
-                    bullet_manager.eraseAlienBullet(i);
+                    publishSnapshot();
+                    pending_events.fetch_or(events);
                 }
-                else if (barrier4.handleCollision(bullet_manager.alien_bullets[i]))
+
+                sf::sleep(tick * (1.0f - timestep.getAlpha()));
+            }
+        }
+
+        // Parks the simulation thread until the main thread resumes it. Returns false if it should stop.
+        bool waitWhilePaused()
+        {
+            std::unique_lock lock{simulation_mutex};
+            while (pause_requested && !stopping)
+            {
+                if (!simulation_paused)
                 {
-                    bullet_manager.eraseAlienBullet(i);
+                    simulation_paused = true;
+                    simulation_state_changed.notify_all();
                 }
+                simulation_state_changed.wait(lock);
             }
 
-            return was_player_hit;
+            return !stopping;
         }
 
-        void nextLevel()
+        // Copies what's drawn of the last tick into the back snapshot and hands it to the renderer. Called by the
+        // simulation thread, or by the main thread while the simulation is paused.
+        void publishSnapshot()
         {
-            bullet_manager.restart();
-            alien_manager.restart();
+            PROFILE_ZONE("Snapshot");
+
+            RenderSnapshot &snapshot = snapshots.getBack();
+            snapshot.sprites.clear();
+
+            const Spaceship &spaceship = simulation.getSpaceship();
+            snapshot.sprites.push_back({
+                spaceship_region,
+                spaceship.getInterpolatedPosition(0.0f),
+                spaceship.getPosition(),
+                {Simulation::spaceship_scale, Simulation::spaceship_scale}
+            });
+
+            const BulletManager &bullet_manager = simulation.getBulletManager();
+            for (const Bullet &bullet : bullet_manager.alien_bullets)
+            {
+                snapshot.sprites.push_back({
+                    bullet_region, bullet.getInterpolatedPosition(0.0f), bullet.getPosition(), Simulation::bullet_scale
+                });
+            }
+
+            if (const auto &bullet = bullet_manager.player_bullet)
+            {
+                snapshot.sprites.push_back({
+                    bullet_region,
+                    bullet->getInterpolatedPosition(0.0f),
+                    bullet->getPosition(),
+                    Simulation::bullet_scale
+                });
+            }
+
+            // The alien formation moves in discrete steps and isn't interpolated
+            const AlienManager &alien_manager = simulation.getAlienManager();
+            const int texture_step = alien_manager.getTextureStep();
+            const sf::Vector2f alien_scale{alien_manager.getScale(), alien_manager.getScale()};
+            for (unsigned int i = 0, e = alien_manager.getCount(); i < e; ++i)
+            {
+                const std::uint8_t state = alien_manager.getState(i);
+                if (state == Alien::Dead)
+                {
+                    continue;
+                }
+
+                const TextureAtlas::Handle region = state & Alien::Alive
+                                                        ? alien_regions[Alien::typeIndex(alien_manager.getType(i))][
+                                                            texture_step]
+                                                        : explosion_region;
+                const sf::Vector2f position = alien_manager.getPosition(i);
+                snapshot.sprites.push_back({region, position, position, alien_scale});
+            }
+
+            auto &barriers = simulation.getBarriers();
+            for (std::size_t i = 0; i < barriers.size(); ++i)
+            {
+                if (const std::optional<sf::IntRect> dirty_rect = barriers[i].takeDirtyRect())
+                {
+                    barrier_damage[i].add(*dirty_rect);
+                }
+
+                // A slot is reused every third snapshot or so, its image may be a few revisions behind
+                RenderSnapshot::BarrierView &view = snapshot.barriers[i];
+                if (view.damage.revision != barrier_damage[i].revision)
+                {
+                    const sf::Image &image = barriers[i].getImage();
+                    if (view.image.getSize() != image.getSize())
+                    {
+                        view.image = image;
+                    }
+                    else
+                    {
+                        const sf::IntRect area = barrier_damage[i].changedSince(view.damage.revision,
+                                                                               {{0, 0}, sf::Vector2i(image.getSize())});
+                        static_cast<void>(view.image.copy(image, sf::Vector2u(area.position), area));
+                    }
+                    view.damage = barrier_damage[i];
+                }
+                view.position = barriers[i].getPosition();
+                view.scale = barriers[i].getScale();
+            }
+
+            snapshot.score = simulation.getScore();
+            snapshot.lives = spaceship.getLives();
+            snapshot.game_over = simulation.isGameOver();
+            snapshot.input_sequence = applied_input_sequence;
+            snapshot.tick_time = std::chrono::steady_clock::now();
+
+            snapshots.publish();
         }
 
-        void restart()
+        void playSounds(const unsigned int events)
         {
-            spaceship.restart();
-            bullet_manager.restart();
-            alien_manager.restart();
-            score = 0;
-            saveHighScore(high_score_path);
-            high_score = loadHighScore(high_score_path);
-            high_score_text.setString("High Score: " + std::to_string(high_score));
+            if (events & Simulation::PlayerShot)
+            {
+                audio.play(shoot_sound);
+            }
+
+            if (events & Simulation::PlayerHit)
+            {
+                audio.play(explosion_sound);
+            }
+
+            if (events & Simulation::AlienKilled)
+            {
+                audio.play(alien_killed_sound);
+            }
+
+            if (events & Simulation::AliensMoved)
+            {
+                audio.play(alien_move_sounds[current_sound_index]);
+                current_sound_index = (current_sound_index + 1) % 4;
+            }
         }
 
-        static int loadHighScore(const std::filesystem::path &path)
+        // Queues every asset the game needs for decoding. Returns true, it's called to initialise a member.
+        bool requestAssets()
         {
-            std::ifstream high_score_file{path};
+            if (asset_pack)
+            {
+                resources.track("assets.pack", "pack", asset_pack->getSize(), 0);
+            }
 
-            if (!high_score_file)
+            asset_loader.request<sf::Font>("fonts/arial.ttf", [this](sf::Font loaded)
             {
-                high_score_file.close();
+                font = resources.add("fonts/arial.ttf", std::move(loaded), getFileSize("fonts/arial.ttf"));
+            });
+
+            images.forEachFile([this](ResourceHandle<sf::Image> &image, const char *file_name)
+            {
+                ++images_pending;
+                std::string name = std::string{"images/"} + file_name;
+                asset_loader.request<sf::Image>(name, [this, &image, name](sf::Image loaded)
+                {
+                    const std::size_t bytes = std::size_t{loaded.getSize().x} * loaded.getSize().y * 4;
+                    image = resources.add(name, std::move(loaded), bytes);
+
+                    // Uploaded as soon as the last sprite is in, sounds may still be decoding
+                    if (--images_pending == 0)
+                    {
+                        buildAtlas();
+                    }
+                });
+            });
+
+            requestSound("shoot.wav", shoot_sound, AudioService::Priority::Normal, 30.0f);
+            requestSound("explosion.wav", explosion_sound, AudioService::Priority::High, 30.0f);
+            requestSound("invader_killed.wav", alien_killed_sound, AudioService::Priority::Normal, 30.0f);
+            // The march beat, cheapest to lose
+            requestSound("invader_move1.wav", alien_move_sounds[0], AudioService::Priority::Low);
+            requestSound("invader_move2.wav", alien_move_sounds[1], AudioService::Priority::Low);
+            requestSound("invader_move3.wav", alien_move_sounds[2], AudioService::Priority::Low);
+            requestSound("invader_move4.wav", alien_move_sounds[3], AudioService::Priority::Low);
+
+            return true;
+        }
 
-                std::cout << "Could not open high_score.txt\n";
-                std::cout << "Trying to create it...\n";
+        void requestSound(const char *file_name,
+                          AudioService::Handle &handle,
+                          const AudioService::Priority priority,
+                          const float volume = 100.0f)
+        {
+            std::string name = std::string{"sounds/"} + file_name;
+            asset_loader.request<SoundSamples>(name, [this, &handle, priority, volume, name](const SoundSamples &sound)
+            {
+                handle = audio.load(sound, priority, volume);
+                // The audio backend keeps its own copy of the samples
+                resources.track(name, "sound", sound.sample_count * sizeof(std::int16_t), 0);
+            });
+        }
 
-                if (std::ofstream of{path}; !of)
+        // Size of the asset's file in the pack or else below the asset root, 0 if there is none
+        [[nodiscard]] std::size_t getFileSize(const std::string &name) const
+        {
+            if (asset_pack)
+            {
+                if (const auto bytes = asset_pack->getBytes(name))
                 {
-                    throw std::ios_base::failure("Failed to create file: " + path.string());
+                    return bytes->second;
                 }
+            }
+
+            std::error_code error;
+            const std::uintmax_t size = std::filesystem::file_size(asset_root / name, error);
+            return error ? 0 : static_cast<std::size_t>(size);
+        }
 
-                std::cout << "high_score.txt created\n";
+        // Blocks until every requested asset is decoded and uploaded, returns the time since startup
+        sf::Time finishLoading()
+        {
+            asset_loader.finish();
+            return startup_clock.getElapsedTime();
+        }
 
-                high_score_file.open("../../assets/high_score.txt");
+        void buildAtlas()
+        {
+            for (std::size_t type = 0; type < images.aliens.size(); ++type)
+            {
+                alien_regions[type] = {atlas.add(*images.aliens[type][0]), atlas.add(*images.aliens[type][1])};
             }
+            explosion_region = atlas.add(*images.explosion);
+            bullet_region = atlas.add(*images.bullet);
+            spaceship_region = atlas.add(*images.spaceship);
 
-            std::string high_score_input;
-            std::getline(high_score_file, high_score_input);
+            // Every barrier is damaged separately, so each needs its own region
+            for (TextureAtlas::Handle &barrier_region : barrier_regions)
+            {
+                barrier_region = atlas.add(*images.barrier);
+            }
 
-            return high_score_input.empty() ? 0 : std::stoi(high_score_input);
+            if (!atlas.build())
+            {
+                std::cerr << "Error creating the texture atlas\n";
+            }
+
+            // The only texture the game uploads itself (SFML manages glyph pages), later barrier updates rewrite pixels
+            // within it
+            const sf::Vector2u atlas_size = atlas.getTexture().getSize();
+            resources.track("atlas", "texture", 0, std::size_t{atlas_size.x} * atlas_size.y * 4);
         }
 
-        void saveHighScore(const std::filesystem::path &path) const
+        // Draws the snapshot's sprites, those that move continuously interpolated by how far the frame is between
+        // the snapshot's tick and the next one
+        void drawWorld(const RenderSnapshot &snapshot)
         {
-            if (score > high_score)
+            PROFILE_ZONE("Draw world");
+
+            const std::chrono::duration<float> since_tick = std::chrono::steady_clock::now() - snapshot.tick_time;
+            const float alpha = std::clamp(since_tick.count() / tick.asSeconds(), 0.0f, 1.0f);
+
+            sprite_batch.clear();
+
+            for (const RenderSnapshot::Sprite &sprite : snapshot.sprites)
+            {
+                const sf::Vector2f &previous = sprite.previous_position;
+                sprite_batch.addCentered(atlas.getTexture(),
+                                         atlas.getRect(sprite.region),
+                                         previous + (sprite.position - previous) * alpha,
+                                         sprite.scale);
+            }
+
+            for (std::size_t i = 0; i < snapshot.barriers.size(); ++i)
             {
-                if (std::ofstream of{path, std::ios::trunc}; !of)
+                const RenderSnapshot::BarrierView &barrier = snapshot.barriers[i];
+                if (uploaded_barrier_revisions[i] != barrier.damage.revision)
                 {
-                    throw std::ios_base::failure("Failed to open file: " + path.string());
+                    const sf::IntRect whole_image{{0, 0}, sf::Vector2i(barrier.image.getSize())};
+                    atlas.update(barrier_regions[i],
+                                 barrier.image,
+                                 barrier.damage.changedSince(uploaded_barrier_revisions[i], whole_image));
+                    uploaded_barrier_revisions[i] = barrier.damage.revision;
                 }
-                else
+
+                const sf::IntRect &rect = atlas.getRect(barrier_regions[i]);
+                sprite_batch.add(atlas.getTexture(), rect, barrier.position, sf::Vector2f(rect.size) * barrier.scale);
+            }
+
+            window.draw(sprite_batch);
+        }
+
+        void drawHud(const RenderSnapshot &snapshot)
+        {
+            PROFILE_ZONE("Draw HUD");
+
+            hud.setValue(lives_counter, snapshot.lives);
+            hud.setValue(score_counter, snapshot.score);
+            hud.update();
+            window.draw(hud);
+
+            if (show_profiler)
+            {
+                // Rebuilding the text every frame would show up in the very numbers it displays
+                if (++frames_since_profiler_refresh >= profiler_refresh_frames)
                 {
-                    of << std::to_string(score);
+                    frames_since_profiler_refresh = 0;
+                    profiler_text.setString(formatProfilerStats() + formatLatencyStats());
                 }
+
+                window.draw(profiler_text);
             }
         }
 
-        void clearHighScore(const std::filesystem::path &path)
+        static std::string formatProfilerStats()
         {
-            high_score = 0;
+            std::string text;
+            for (const Profiler::PhaseStats &stats : Profiler::instance().getPhaseStats())
+            {
+                std::array<char, 96> line{};
+                std::snprintf(line.data(), line.size(), "%-12s p50 %7.3f ms   p99 %7.3f ms\n",
+                              stats.name, stats.p50_ms, stats.p99_ms);
+                text += line.data();
+            }
 
-            if (std::ofstream of{path, std::ios::trunc}; !of)
+            return text;
+        }
+
+        [[nodiscard]] std::string formatLatencyStats() const
+        {
+            std::string text;
+            const std::pair<const char *, const LatencyHistogram *> histograms[] = {
+                {"Input to tick", &input_to_tick_latency},
+                {"Input to present", &input_to_present_latency}
+            };
+            for (const auto &[name, histogram] : histograms)
             {
-                throw std::ios_base::failure("Failed to open file: " + path.string());
+                std::array<char, 96> line{};
+                std::snprintf(line.data(), line.size(), "%-16s p50 %5.1f ms   p99 %5.1f ms   (%llu inputs)\n",
+                              name, histogram->percentile(0.50), histogram->percentile(0.99),
+                              static_cast<unsigned long long>(histogram->getCount()));
+                text += line.data();
             }
-            else
+
+            return text;
+        }
+
+        void restart()
+        {
+            submitHighScore();
+            saveReplay();
+
+            const std::uint32_t seed = std::random_device{}();
+            simulation.reset(seed);
+            replay = Replay{seed, replay.getFormation()};
+            // Input meant for the old game is dropped, the held keys are synced again once it's running
+            input_queue.clear();
+            unpresented_inputs.clear();
+            applied_input_sequence = 0;
+            left_down = false;
+            right_down = false;
+            // So the renderer doesn't keep drawing the old game until the simulation thread publishes
+            publishSnapshot();
+            snapshots.update();
+        }
+
+        void saveReplay()
+        {
+            replay.finish(simulation.getScore(), simulation.getStateHash());
+            if (!replay.save(replay_path))
+            {
+                std::cerr << "Error writing " << replay_path << '\n';
+            }
+        }
+
+        // The file is only written if the score beats what's in it, which may not have been read yet
+        void submitHighScore()
+        {
+            const int score = simulation.getScore();
+            high_score_file.submitScore(score);
+            if (score > high_score)
             {
-                of << std::to_string(0);
+                high_score = score;
+                hud.setValue(high_score_counter, high_score);
             }
         }
 };
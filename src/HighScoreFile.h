@@ -0,0 +1,212 @@
+#ifndef HIGHSCOREFILE_H
+#define HIGHSCOREFILE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+// Reads and writes the high score file on a thread of its own, in the order the requests were made, so the game
+// loop never waits for the disk. I/O errors are kept and rethrown by flush().
+class HighScoreFile
+{
+    using Task = std::function<void()>;
+
+    const std::filesystem::path path;
+
+    std::mutex mutex;
+    std::condition_variable state_changed;
+    std::deque<Task> tasks{};
+    bool busy = false;
+    bool stopping = false;
+    // First I/O error, rethrown by flush()
+    std::exception_ptr failure{};
+
+    // The score in the file as far as the worker knows, only touched by it
+    int best = 0;
+    // Set by the worker once load() is done, -1 until then
+    std::atomic<int> loaded{-1};
+
+    // Declared last, so it's started after everything it uses
+    std::thread worker;
+
+    public:
+        explicit HighScoreFile(std::filesystem::path path) : path(std::move(path)), worker([this]
+        {
+            work();
+        })
+        {
+        }
+
+        HighScoreFile(const HighScoreFile &) = delete;
+        HighScoreFile &operator=(const HighScoreFile &) = delete;
+
+        // Finishes every queued request first
+        ~HighScoreFile()
+        {
+            {
+                const std::lock_guard lock{mutex};
+                stopping = true;
+            }
+            state_changed.notify_all();
+            worker.join();
+        }
+
+        // Reads the high score, creating the file if there is none. takeLoaded() returns it once it's read.
+        void load()
+        {
+            submit([this]
+            {
+                best = read(path);
+                loaded = best;
+            });
+        }
+
+        // The high score read by the last load(), returned once
+        std::optional<int> takeLoaded()
+        {
+            if (const int score = loaded.exchange(-1); score >= 0)
+            {
+                return score;
+            }
+
+            return std::nullopt;
+        }
+
+        // Writes score if it beats the high score read by load() or written since
+        void submitScore(const int score)
+        {
+            submit([this, score]
+            {
+                if (score > best)
+                {
+                    write(score);
+                }
+            });
+        }
+
+        void clear()
+        {
+            submit([this]
+            {
+                write(0);
+            });
+        }
+
+        // Blocks until every request so far is done. Rethrows the first I/O error.
+        void flush()
+        {
+            std::unique_lock lock{mutex};
+            state_changed.wait(lock, [this]
+            {
+                return tasks.empty() && !busy;
+            });
+
+            if (failure)
+            {
+                std::rethrow_exception(std::exchange(failure, nullptr));
+            }
+        }
+
+    private:
+        void submit(Task task)
+        {
+            {
+                const std::lock_guard lock{mutex};
+                tasks.push_back(std::move(task));
+            }
+            state_changed.notify_all();
+        }
+
+        void work()
+        {
+            std::unique_lock lock{mutex};
+            while (true)
+            {
+                state_changed.wait(lock, [this]
+                {
+                    return stopping || !tasks.empty();
+                });
+
+                if (tasks.empty())
+                {
+                    return;
+                }
+
+                Task task = std::move(tasks.front());
+                tasks.pop_front();
+                busy = true;
+                lock.unlock();
+
+                std::exception_ptr error;
+                try
+                {
+                    task();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                lock.lock();
+                busy = false;
+                if (error && !failure)
+                {
+                    failure = error;
+                }
+                state_changed.notify_all();
+            }
+        }
+
+        void write(const int score)
+        {
+            if (std::ofstream of{path, std::ios::trunc}; !of)
+            {
+                throw std::ios_base::failure("Failed to open file: " + path.string());
+            }
+            else
+            {
+                of << std::to_string(score);
+            }
+
+            best = score;
+        }
+
+        static int read(const std::filesystem::path &path)
+        {
+            std::ifstream high_score_file{path};
+
+            if (!high_score_file)
+            {
+                high_score_file.close();
+
+                std::cout << "Could not open high_score.txt\n";
+                std::cout << "Trying to create it...\n";
+
+                if (std::ofstream of{path}; !of)
+                {
+                    throw std::ios_base::failure("Failed to create file: " + path.string());
+                }
+
+                std::cout << "high_score.txt created\n";
+
+                high_score_file.open(path);
+            }
+
+            std::string high_score_input;
+            std::getline(high_score_file, high_score_input);
+
+            return high_score_input.empty() ? 0 : std::stoi(high_score_input);
+        }
+};
+
+#endif //HIGHSCOREFILE_H
@@ -0,0 +1,227 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "ResourceRegistry.h"
+
+// Labelled numbers ("Score: 120") drawn from glyph quads shaped once up front. Geometry is only rebuilt when a
+// value changes and then reuses its vertex storage, so steady-state frames neither allocate nor lay out text.
+// Laid out like a bold sf::Text of the same font, size and position.
+class Hud final : public sf::Drawable
+{
+    // Characters a value can be made of, '-' comes after the digits
+    static constexpr std::string_view value_characters = "0123456789-";
+    static constexpr std::size_t minus_index = 10;
+    // Longest int including the sign
+    static constexpr std::size_t max_value_length = 11;
+
+    // Same padding sf::Text puts around every glyph quad
+    static constexpr float glyph_padding = 1.0f;
+
+    struct ShapedGlyph
+    {
+        sf::FloatRect bounds;
+        sf::FloatRect texture_rect;
+        float advance;
+    };
+
+    struct Counter
+    {
+        // Label quads, already positioned
+        std::vector<sf::Vertex> label_vertices;
+        // Pen position where the value starts, on the baseline
+        sf::Vector2f value_origin;
+        // Kerning between the last label character and each value character
+        std::array<float, value_characters.size()> label_kerning;
+        int value;
+    };
+
+    const ResourceHandle<sf::Font> font;
+    const unsigned int character_size;
+    const sf::Color color;
+
+    std::array<ShapedGlyph, value_characters.size()> value_glyphs{};
+    // Kerning between two value characters, indexed [previous][next]
+    std::array<std::array<float, value_characters.size()>, value_characters.size()> value_kerning{};
+
+    std::vector<Counter> counters{};
+    std::vector<sf::Vertex> vertices{};
+    bool dirty = true;
+
+    public:
+        Hud(const ResourceHandle<sf::Font> &font, const unsigned int character_size, const sf::Color color) :
+            font(font), character_size(character_size), color(color)
+        {
+            for (std::size_t i = 0; i < value_characters.size(); ++i)
+            {
+                value_glyphs[i] = shape(value_characters[i]);
+
+                for (std::size_t next = 0; next < value_characters.size(); ++next)
+                {
+                    value_kerning[i][next] = font->getKerning(value_characters[i], value_characters[next],
+                                                             character_size, true);
+                }
+            }
+        }
+
+        // Adds "label value" with the top left corner at position, returns the counter's index for setValue()
+        std::size_t addCounter(const std::string_view label, const sf::Vector2f &position, const int value = 0)
+        {
+            Counter &counter = counters.emplace_back();
+            counter.value = value;
+
+            // Pen on the baseline, which sf::Text puts one character size below the top
+            sf::Vector2f pen{position.x, position.y + static_cast<float>(character_size)};
+            char previous = 0;
+            for (const char character : label)
+            {
+                if (previous != 0)
+                {
+                    pen.x += font->getKerning(previous, character, character_size, true);
+                }
+
+                const ShapedGlyph glyph = shape(character);
+                if (character != ' ')
+                {
+                    appendQuad(counter.label_vertices, glyph, pen);
+                }
+                pen.x += glyph.advance;
+                previous = character;
+            }
+
+            counter.value_origin = pen;
+            for (std::size_t i = 0; i < value_characters.size(); ++i)
+            {
+                counter.label_kerning[i] = previous != 0
+                                               ? font->getKerning(previous, value_characters[i], character_size, true)
+                                               : 0.0f;
+            }
+
+            // Room for every counter at its longest, so later rebuilds never grow the storage
+            vertices.reserve(vertices.capacity() + counter.label_vertices.size() + max_value_length * 6);
+            dirty = true;
+
+            return counters.size() - 1;
+        }
+
+        void setValue(const std::size_t counter, const int value)
+        {
+            if (counters[counter].value != value)
+            {
+                counters[counter].value = value;
+                dirty = true;
+            }
+        }
+
+        // Rebuilds the geometry if a value changed since the last call
+        void update()
+        {
+            if (!dirty)
+            {
+                return;
+            }
+
+            vertices.clear();
+            for (const Counter &counter : counters)
+            {
+                vertices.insert(vertices.end(), counter.label_vertices.begin(), counter.label_vertices.end());
+                appendValue(counter);
+            }
+
+            dirty = false;
+        }
+
+    protected:
+        void draw(sf::RenderTarget &target, sf::RenderStates states) const override
+        {
+            states.texture = &font->getTexture(character_size);
+            target.draw(vertices.data(), vertices.size(), sf::PrimitiveType::Triangles, states);
+        }
+
+    private:
+        // Loads the glyph into the font's texture, so the texture doesn't change once everything is shaped
+        [[nodiscard]] ShapedGlyph shape(const char character) const
+        {
+            const sf::Glyph &glyph = font->getGlyph(static_cast<unsigned char>(character), character_size, true);
+            return {
+                {
+                    glyph.bounds.position - sf::Vector2f{glyph_padding, glyph_padding},
+                    glyph.bounds.size + sf::Vector2f{2 * glyph_padding, 2 * glyph_padding}
+                },
+                {
+                    sf::Vector2f(glyph.textureRect.position) - sf::Vector2f{glyph_padding, glyph_padding},
+                    sf::Vector2f(glyph.textureRect.size) + sf::Vector2f{2 * glyph_padding, 2 * glyph_padding}
+                },
+                glyph.advance
+            };
+        }
+
+        void appendValue(const Counter &counter)
+        {
+            // Digits come out backwards, collect them first
+            std::array<std::size_t, max_value_length> characters{};
+            std::size_t length = 0;
+
+            // Negate in unsigned arithmetic so INT_MIN works as well
+            const bool negative = counter.value < 0;
+            std::uint32_t magnitude = negative
+                                          ? 0u - static_cast<std::uint32_t>(counter.value)
+                                          : static_cast<std::uint32_t>(counter.value);
+            do
+            {
+                characters[length++] = magnitude % 10;
+                magnitude /= 10;
+            }
+            while (magnitude != 0);
+
+            if (negative)
+            {
+                characters[length++] = minus_index;
+            }
+
+            sf::Vector2f pen = counter.value_origin;
+            for (std::size_t i = length; i-- > 0;)
+            {
+                const std::size_t character = characters[i];
+                pen.x += i + 1 == length
+                             ? counter.label_kerning[character]
+                             : value_kerning[characters[i + 1]][character];
+
+                appendQuad(vertices, value_glyphs[character], pen);
+                pen.x += value_glyphs[character].advance;
+            }
+        }
+
+        void appendQuad(std::vector<sf::Vertex> &target, const ShapedGlyph &glyph, const sf::Vector2f &pen) const
+        {
+            const sf::Vector2f top_left = pen + glyph.bounds.position;
+            const sf::Vector2f bottom_right = top_left + glyph.bounds.size;
+            const sf::Vector2f tex_top_left = glyph.texture_rect.position;
+            const sf::Vector2f tex_bottom_right = tex_top_left + glyph.texture_rect.size;
+
+            const sf::Vertex top_left_vertex{top_left, color, tex_top_left};
+            const sf::Vertex top_right_vertex{
+                {bottom_right.x, top_left.y}, color, {tex_bottom_right.x, tex_top_left.y}
+            };
+            const sf::Vertex bottom_left_vertex{
+                {top_left.x, bottom_right.y}, color, {tex_top_left.x, tex_bottom_right.y}
+            };
+            const sf::Vertex bottom_right_vertex{bottom_right, color, tex_bottom_right};
+
+            // Two triangles per quad
+            target.push_back(top_left_vertex);
+            target.push_back(top_right_vertex);
+            target.push_back(bottom_left_vertex);
+            target.push_back(bottom_left_vertex);
+            target.push_back(top_right_vertex);
+            target.push_back(bottom_right_vertex);
+        }
+};
+
+#endif //HUD_H
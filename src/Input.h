@@ -0,0 +1,12 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+// Player input for a single simulation step, decoupled from sf::Keyboard so the simulation can be driven headless
+struct Input
+{
+    bool left = false;
+    bool right = false;
+    bool shoot = false;
+};
+
+#endif //INPUT_H
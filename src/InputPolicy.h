@@ -0,0 +1,142 @@
+#ifndef INPUTPOLICY_H
+#define INPUTPOLICY_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string_view>
+
+#include "Input.h"
+#include "Simulation.h"
+
+// Decides the input of every tick for an automated player. One instance drives one game at a time and may keep
+// state between ticks, so games running in parallel each need their own.
+class InputPolicy
+{
+    public:
+        virtual ~InputPolicy() = default;
+
+        virtual Input nextInput(const Simulation &simulation) = 0;
+};
+
+// Sweeps across the screen, turning every 300 ticks, and shoots whenever it can
+class SweepPolicy final : public InputPolicy
+{
+    long tick = 0;
+
+    public:
+        Input nextInput(const Simulation &) override
+        {
+            const bool go_left = (tick++ / 300) % 2 == 0;
+            return Input{go_left, !go_left, true};
+        }
+};
+
+// Holds a random direction for a random number of ticks, shoots at random
+class RandomPolicy final : public InputPolicy
+{
+    std::mt19937 rng;
+    std::uniform_int_distribution<int> direction_dist{0, 2};
+    std::uniform_int_distribution<int> hold_dist{10, 200};
+    std::bernoulli_distribution shoot_dist{0.2};
+
+    int direction = 0;
+    int hold_ticks = 0;
+
+    public:
+        explicit RandomPolicy(const std::uint32_t seed) : rng(seed)
+        {
+        }
+
+        Input nextInput(const Simulation &) override
+        {
+            if (hold_ticks-- <= 0)
+            {
+                direction = direction_dist(rng);
+                hold_ticks = hold_dist(rng);
+            }
+
+            return Input{direction == 1, direction == 2, shoot_dist(rng)};
+        }
+};
+
+// Moves under the nearest live alien and shoots when lined up, sidestepping alien bullets about to hit it
+class TrackerPolicy final : public InputPolicy
+{
+    // How far above the ship an alien bullet is considered a threat
+    static constexpr float danger_height = 200.0f;
+    static constexpr float aim_tolerance = 8.0f;
+
+    public:
+        Input nextInput(const Simulation &simulation) override
+        {
+            const sf::FloatRect ship = simulation.getSpaceship().getBounds();
+            const float ship_x = ship.position.x + ship.size.x / 2.0f;
+
+            for (const Bullet &bullet : simulation.getBulletManager().alien_bullets)
+            {
+                const sf::Vector2f position = bullet.getPosition();
+                if (position.x + bullet.hit_width >= ship.position.x && position.x <= ship.position.x + ship.size.x
+                    && position.y < ship.position.y && ship.position.y - position.y < danger_height)
+                {
+                    // Step away from the side the bullet is on
+                    const bool go_left = position.x >= ship_x;
+                    return Input{go_left, !go_left, false};
+                }
+            }
+
+            const AlienManager &alien_manager = simulation.getAlienManager();
+            std::optional<float> target_x;
+            for (unsigned int i = 0, e = alien_manager.getCount(); i < e; ++i)
+            {
+                if (!(alien_manager.getState(i) & Alien::Alive))
+                {
+                    continue;
+                }
+
+                const float x = alien_manager.getPosition(i).x;
+                if (!target_x || std::abs(x - ship_x) < std::abs(*target_x - ship_x))
+                {
+                    target_x = x;
+                }
+            }
+
+            if (!target_x)
+            {
+                return Input{};
+            }
+
+            const float offset = *target_x - ship_x;
+            const bool lined_up = std::abs(offset) <= aim_tolerance;
+            return Input{!lined_up && offset < 0.0f, !lined_up && offset > 0.0f, lined_up};
+        }
+};
+
+// Names accepted by makeInputPolicy()
+inline constexpr std::array<std::string_view, 3> input_policy_names = {"sweep", "random", "tracker"};
+
+// Returns nothing for an unknown name. seed only matters for policies that use randomness.
+inline std::unique_ptr<InputPolicy> makeInputPolicy(const std::string_view name, const std::uint32_t seed)
+{
+    if (name == "sweep")
+    {
+        return std::make_unique<SweepPolicy>();
+    }
+
+    if (name == "random")
+    {
+        return std::make_unique<RandomPolicy>(seed);
+    }
+
+    if (name == "tracker")
+    {
+        return std::make_unique<TrackerPolicy>();
+    }
+
+    return nullptr;
+}
+
+#endif //INPUTPOLICY_H
@@ -0,0 +1,120 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "Input.h"
+
+// Player input events stamped with when they were received, handed from the thread handling window events to the
+// simulation thread. Each event is applied at the first tick ending after its timestamp, so input received between
+// frames still lands on the tick it belongs to instead of the one after the next frame.
+class InputQueue
+{
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Action : std::uint8_t
+        {
+            LeftPressed,
+            LeftReleased,
+            RightPressed,
+            RightReleased,
+            Shoot
+        };
+
+        struct Event
+        {
+            Action action;
+            Clock::time_point time;
+            // Numbered from 1 in push order
+            std::uint64_t sequence;
+        };
+
+    private:
+        std::mutex mutex;
+        std::deque<Event> events{};
+        std::uint64_t pushed = 0;
+
+        // Only touched by the consuming thread
+        bool left_held = false;
+        bool right_held = false;
+
+    public:
+        // Returns the event's sequence number
+        std::uint64_t push(const Action action, const Clock::time_point time = Clock::now())
+        {
+            const std::lock_guard lock{mutex};
+            events.push_back({action, time, ++pushed});
+            return pushed;
+        }
+
+        // Moves every queued event received before time to time. For when the simulation resumes after a stop, so
+        // input received meanwhile is applied once it runs again and the stop doesn't count as latency.
+        void delayTo(const Clock::time_point time)
+        {
+            const std::lock_guard lock{mutex};
+            for (Event &event : events)
+            {
+                event.time = std::max(event.time, time);
+            }
+        }
+
+        // Forgets every queued event and held direction and numbers events from 1 again. The consuming thread
+        // must not be taking a tick meanwhile.
+        void clear()
+        {
+            const std::lock_guard lock{mutex};
+            events.clear();
+            pushed = 0;
+            left_held = false;
+            right_held = false;
+        }
+
+        // The input of the tick ending at tick_end: applies every event stamped up to then and hands each to
+        // on_applied. A direction pressed and released within the tick still moves the ship for that tick.
+        template<typename OnApplied>
+        Input takeTick(const Clock::time_point tick_end, OnApplied on_applied)
+        {
+            Input input{left_held, right_held, false};
+
+            const std::lock_guard lock{mutex};
+            while (!events.empty() && events.front().time <= tick_end)
+            {
+                const Event event = events.front();
+                events.pop_front();
+
+                switch (event.action)
+                {
+                    case Action::LeftPressed:
+                        left_held = input.left = true;
+                        break;
+
+                    case Action::LeftReleased:
+                        left_held = false;
+                        break;
+
+                    case Action::RightPressed:
+                        right_held = input.right = true;
+                        break;
+
+                    case Action::RightReleased:
+                        right_held = false;
+                        break;
+
+                    case Action::Shoot:
+                        input.shoot = true;
+                        break;
+                }
+
+                on_applied(event);
+            }
+
+            return input;
+        }
+};
+
+#endif //INPUTQUEUE_H
@@ -0,0 +1,69 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Counts latencies in 0.1 ms buckets up to 50 ms, longer ones share the last bucket. One thread may record while
+// others read the percentiles, the counts are relaxed atomics so a read may miss the latest few samples.
+class LatencyHistogram
+{
+    public:
+        static constexpr std::int64_t bucket_us = 100;
+        static constexpr std::size_t bucket_count = 501;
+
+    private:
+        std::array<std::atomic<std::uint32_t>, bucket_count> buckets{};
+        std::atomic<std::uint64_t> sample_count{0};
+
+    public:
+        void record(const std::chrono::steady_clock::duration latency)
+        {
+            const std::int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+            const auto bucket = static_cast<std::size_t>(std::clamp<std::int64_t>(us / bucket_us, 0, bucket_count - 1));
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            sample_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::uint64_t getCount() const
+        {
+            return sample_count.load(std::memory_order_relaxed);
+        }
+
+        // Upper bound in milliseconds of the bucket holding the given fraction of the samples, 0 without samples
+        [[nodiscard]] double percentile(const double fraction) const
+        {
+            const std::uint64_t count = getCount();
+            if (count == 0)
+            {
+                return 0.0;
+            }
+
+            const auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(count - 1));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < bucket_count; ++i)
+            {
+                seen += buckets[i].load(std::memory_order_relaxed);
+                if (seen > rank)
+                {
+                    return static_cast<double>((i + 1) * bucket_us) / 1000.0;
+                }
+            }
+
+            return static_cast<double>(bucket_count * bucket_us) / 1000.0;
+        }
+
+        void clear()
+        {
+            for (std::atomic<std::uint32_t> &bucket : buckets)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            sample_count.store(0, std::memory_order_relaxed);
+        }
+};
+
+#endif //LATENCYHISTOGRAM_H
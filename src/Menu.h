@@ -1,20 +1,23 @@
 #ifndef MENU_H
 #define MENU_H
 
-#include <filesystem>
+#include <array>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include <SFML/Graphics.hpp>
 
+#include "ResourceRegistry.h"
+
+// Menu screens drawn over a cleared window. A screen is opened with openMainMenu() or openGameOverScreen(), after
+// which the game loop passes it its events until handleEvent() returns the picked item, and draws it whenever
+// takeChanged() says it looks different.
+// The texts are built once, with a second ">" version of every item for when it's selected, so drawing doesn't
+// create or copy any text.
 class Menu
 {
-    const sf::Font font;
-    const std::array<const std::string, 4> menu_items = {"Resume", "Restart", "Clear High Score", "Exit"};
-    std::vector<sf::Text> menu_texts{};
-    static constexpr float spacing = 60.0f;
-    static constexpr int char_size = 36;
-
     public:
         enum class MenuResult
         {
@@ -24,175 +27,180 @@ class Menu
             Exit
         };
 
-        explicit Menu(const std::filesystem::path &filename) : font(filename)
+    private:
+        struct Item
         {
-        }
+            sf::Text text;
+            sf::Text selected_text;
+            MenuResult result;
+        };
 
-        explicit Menu(sf::Font font) : font(std::move(font))
+        const ResourceHandle<sf::Font> font;
+        const std::array<std::pair<const char *, MenuResult>, 4> menu_items = {
+            {
+                {"Resume", MenuResult::Resume},
+                {"Restart", MenuResult::Restart},
+                {"Clear High Score", MenuResult::ClearHighScore},
+                {"Exit", MenuResult::Exit}
+            }
+        };
+        static constexpr float spacing = 60.0f;
+        static constexpr int char_size = 36;
+
+        // Built the first time the screen is opened, the window size is fixed
+        std::vector<Item> main_menu{};
+        std::vector<Item> game_over_menu{};
+
+        // The open screen
+        const std::vector<Item> *items = nullptr;
+        std::optional<sf::Text> title{};
+        unsigned int selected = 0;
+        // What Escape picks, if anything
+        std::optional<MenuResult> escape_result{};
+        // Whether the screen needs drawing again since the last takeChanged()
+        bool changed = false;
+
+    public:
+        explicit Menu(ResourceHandle<sf::Font> font) : font(std::move(font))
         {
         }
 
-        MenuResult openMainMenu(sf::RenderWindow &window)
+        void openMainMenu(const sf::RenderWindow &window)
         {
-            const float window_center_x = window.getSize().x / 2.0f;
-            float y_pos = 0.2f * window.getSize().y;
-
-            menu_texts.clear();
-            for (const auto &menu_item : menu_items)
+            if (main_menu.empty())
             {
-                y_pos += spacing;
-
-                menu_texts.emplace_back(createCenteredText(font, menu_item, char_size, window_center_x, y_pos));
-            }
+                const float window_center_x = window.getSize().x / 2.0f;
+                float y_pos = 0.2f * window.getSize().y;
 
-            unsigned int selected = 0;
-            while (window.isOpen())
-            {
-                // Process events
-                while (const std::optional event = window.pollEvent())
+                for (const auto &[menu_item, result] : menu_items)
                 {
-                    if (event->is<sf::Event::Closed>())
-                    {
-                        window.close();
-                    }
-                    else if (const auto *key_pressed = event->getIf<sf::Event::KeyPressed>())
-                    {
-                        if (key_pressed->scancode == sf::Keyboard::Scan::Escape)
-                        {
-                            // Close the menu
-                            return MenuResult::Resume;
-                        }
-
-                        if (key_pressed->scancode == sf::Keyboard::Scan::Down)
-                        {
-                            selected = (selected + 1) % 4;
-                        }
-                        else if (key_pressed->scancode == sf::Keyboard::Scan::Up)
-                        {
-                            selected = (selected - 1) % 4;
-                        }
-                        else if (key_pressed->scancode == sf::Keyboard::Scan::Space || key_pressed->scancode ==
-                            sf::Keyboard::Scan::Enter)
-                        {
-                            switch (selected)
-                            {
-                                case 0:
-                                    return MenuResult::Resume;
-                                case 1:
-                                    return MenuResult::Restart;
-                                case 2:
-                                    return MenuResult::ClearHighScore;
-                                case 3:
-                                    return MenuResult::Exit;
-
-                                default:
-                                    std::cout << "No such menu item\n";
-                                    break;
-                            }
-                        }
-                    }
-                }
+                    y_pos += spacing;
 
-                window.clear();
-
-                for (size_t i = 0, e = menu_texts.size(); i < e; ++i)
-                {
-                    auto text = menu_texts[i];
-
-                    if (i == selected)
-                    {
-                        text.setString(">" + text.getString());
-                    }
-
-                    window.draw(text);
+                    main_menu.push_back(createItem(menu_item, result, window_center_x, y_pos));
                 }
-
-                window.display();
             }
 
-            return MenuResult::Exit;
+            // Escape closes the menu
+            open(main_menu, std::nullopt, MenuResult::Resume);
         }
 
-        MenuResult openGameOverScreen(sf::RenderWindow &window, const int final_score)
+        void openGameOverScreen(const sf::RenderWindow &window, const int final_score)
         {
             const float window_center_x = window.getSize().x / 2.0f;
             float y_pos = 0.2f * window.getSize().y;
 
-            menu_texts.clear();
+            sf::Text final_score_text = createCenteredText(*font,
+                                                           "Final score: " + std::to_string(final_score),
+                                                           char_size,
+                                                           window_center_x,
+                                                           y_pos);
 
-            menu_texts.emplace_back(createCenteredText(font,
-                                                       "Final score: " + std::to_string(final_score),
-                                                       char_size,
-                                                       window_center_x,
-                                                       y_pos));
-            y_pos += spacing;
-            menu_texts.emplace_back(createCenteredText(font, "Restart?", char_size, window_center_x, y_pos));
-            y_pos += spacing;
-            menu_texts.emplace_back(createCenteredText(font, "Exit", char_size, window_center_x, y_pos));
+            if (game_over_menu.empty())
+            {
+                y_pos += spacing;
+                game_over_menu.push_back(createItem("Restart?", MenuResult::Restart, window_center_x, y_pos));
+                y_pos += spacing;
+                game_over_menu.push_back(createItem("Exit", MenuResult::Exit, window_center_x, y_pos));
+            }
 
-            int selected = 1;
+            open(game_over_menu, std::move(final_score_text), std::nullopt);
+        }
 
-            while (window.isOpen())
+        // Moves the selection, returns the picked item's result once one is picked, which closes the screen
+        std::optional<MenuResult> handleEvent(const sf::Event &event)
+        {
+            const auto *key_pressed = event.getIf<sf::Event::KeyPressed>();
+            if (!items || !key_pressed)
             {
-                // Process events
-                while (const std::optional event = window.pollEvent())
-                {
-                    if (event->is<sf::Event::Closed>())
-                    {
-                        window.close();
-                    }
-                    else if (const auto *key_pressed = event->getIf<sf::Event::KeyPressed>())
-                    {
-                        constexpr int low = 1;
-                        constexpr int high = 2;
-
-                        if (key_pressed->scancode == sf::Keyboard::Scan::Down)
-                        {
-                            // selected = std::clamp(selected + 1, low, high);
-                            selected = wrap(selected + 1, low, high);
-                        }
-                        else if (key_pressed->scancode == sf::Keyboard::Scan::Up)
-                        {
-                            selected = wrap(selected - 1, low, high);
-                        }
-                        else if (key_pressed->scancode == sf::Keyboard::Scan::Space || key_pressed->scancode ==
-                            sf::Keyboard::Scan::Enter)
-                        {
-                            switch (selected)
-                            {
-                                case 1:
-                                    return MenuResult::Restart;
-                                case 2:
-                                    return MenuResult::Exit;
-
-                                default:
-                                    std::cout << "No such menu item\n";
-                                    break;
-                            }
-                        }
-                    }
-                }
+                return std::nullopt;
+            }
+
+            const auto item_count = static_cast<unsigned int>(items->size());
+            std::optional<MenuResult> result;
+            if (key_pressed->scancode == sf::Keyboard::Scan::Escape)
+            {
+                result = escape_result;
+            }
+            else if (key_pressed->scancode == sf::Keyboard::Scan::Down)
+            {
+                selected = (selected + 1) % item_count;
+                changed = true;
+            }
+            else if (key_pressed->scancode == sf::Keyboard::Scan::Up)
+            {
+                selected = (selected + item_count - 1) % item_count;
+                changed = true;
+            }
+            else if (key_pressed->scancode == sf::Keyboard::Scan::Space || key_pressed->scancode ==
+                sf::Keyboard::Scan::Enter)
+            {
+                result = (*items)[selected].result;
+            }
 
-                window.clear();
+            if (result)
+            {
+                items = nullptr;
+            }
 
-                for (int i = 0, e = menu_texts.size(); i < e; ++i)
-                {
-                    auto text = menu_texts[i];
+            return result;
+        }
 
-                    if (i != 0 && i == selected)
-                    {
-                        text.setString(">" + text.getString());
-                    }
-                    window.draw(text);
-                }
+        [[nodiscard]] bool isOpen() const
+        {
+            return items != nullptr;
+        }
+
+        // For when the window lost what was drawn, after a resize or coming back into focus
+        void invalidate()
+        {
+            changed = true;
+        }
+
+        // Whether the open screen was opened, moved its selection or was invalidated since the last call
+        bool takeChanged()
+        {
+            return std::exchange(changed, false);
+        }
 
-                window.display();
+        void draw(sf::RenderTarget &target) const
+        {
+            if (!items)
+            {
+                return;
+            }
+
+            if (title)
+            {
+                target.draw(*title);
             }
 
-            return MenuResult::Exit;
+            for (unsigned int i = 0; i < items->size(); ++i)
+            {
+                target.draw(i == selected ? (*items)[i].selected_text : (*items)[i].text);
+            }
         }
 
     private:
+        void open(const std::vector<Item> &screen, std::optional<sf::Text> screen_title,
+                  const std::optional<MenuResult> on_escape)
+        {
+            items = &screen;
+            title = std::move(screen_title);
+            selected = 0;
+            escape_result = on_escape;
+            changed = true;
+        }
+
+        [[nodiscard]] Item createItem(const std::string &str, const MenuResult result, const float x,
+                                      const float y) const
+        {
+            return Item{
+                createCenteredText(*font, str, char_size, x, y),
+                createCenteredText(*font, ">" + str, char_size, x, y),
+                result
+            };
+        }
+
         static sf::Text createCenteredText(const sf::Font &font,
                                            const std::string &str,
                                            const unsigned int charSize,
@@ -211,25 +219,6 @@ class Menu
             text.setPosition({x, y});
             return text;
         }
-
-        static int wrap(const int value, const int min, const int max)
-        {
-            const int range = max - min + 1;
-
-            if (value < min || value > max)
-            {
-                int normalized = (value - min) % range;
-
-                if (normalized < 0)
-                {
-                    normalized += range;
-                }
-
-                return min + normalized;
-            }
-
-            return value;
-        }
 };
 
 #endif //MENU_H
@@ -0,0 +1,300 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Scoped-zone frame profiler. PROFILE_ZONE("name") records when the enclosing scope begins and ends into a ring
+// buffer owned by the calling thread, so recording takes no lock. Other threads read the rings through a sequence
+// number per slot and skip zones that are overwritten while they read them.
+// Zones are only recorded when built with SPACE_INVADERS_PROFILE defined (CMake option of the same name),
+// otherwise PROFILE_ZONE expands to nothing.
+class Profiler final
+{
+    public:
+#ifdef SPACE_INVADERS_PROFILE
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        // Zones kept per thread, older ones are overwritten
+        static constexpr std::size_t zone_capacity = 1 << 15;
+        // Frames the per-phase percentiles are computed over
+        static constexpr std::size_t history_frames = 240;
+
+        struct PhaseStats
+        {
+            const char *name;
+            double p50_ms;
+            double p99_ms;
+        };
+
+    private:
+        struct Zone
+        {
+            // Zone names are string literals, so the pointer identifies the phase
+            const char *name;
+            std::int64_t begin_ns;
+            std::int64_t end_ns;
+        };
+
+        // A zone in a ring buffer. Written by the owning thread while others may read it, so every field is atomic.
+        struct Slot
+        {
+            // 1 + the index of the zone the slot holds, 0 while it's being written
+            std::atomic<std::size_t> sequence{0};
+            std::atomic<const char *> name{nullptr};
+            std::atomic<std::int64_t> begin_ns{0};
+            std::atomic<std::int64_t> end_ns{0};
+        };
+
+        struct ThreadBuffer
+        {
+            std::array<Slot, zone_capacity> slots{};
+            // Total zones ever recorded, published after the zone is written
+            std::atomic<std::size_t> next{0};
+            // First zone of the frame in progress, see endFrame()
+            std::size_t frame_begin = 0;
+            unsigned int thread_id;
+        };
+
+        struct PhaseHistory
+        {
+            const char *name;
+            std::vector<float> frame_ms = std::vector<float>(history_frames);
+        };
+
+        static inline thread_local ThreadBuffer *thread_buffer = nullptr;
+
+        const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        mutable std::mutex buffers_mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers{};
+
+        std::vector<PhaseHistory> phases{};
+        std::size_t frame_count = 0;
+
+        Profiler() = default;
+
+    public:
+        Profiler(const Profiler &) = delete;
+        Profiler &operator=(const Profiler &) = delete;
+
+        static Profiler &instance()
+        {
+            static Profiler profiler;
+            return profiler;
+        }
+
+        // Nanoseconds since the profiler was created
+        [[nodiscard]] std::int64_t now() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).
+                count();
+        }
+
+        void record(const char *name, const std::int64_t begin_ns, const std::int64_t end_ns)
+        {
+            ThreadBuffer &buffer = getThreadBuffer();
+            const std::size_t next = buffer.next.load(std::memory_order_relaxed);
+
+            // Readers that see the new fields also see the slot marked as being written
+            Slot &slot = buffer.slots[next % zone_capacity];
+            slot.sequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.name.store(name, std::memory_order_relaxed);
+            slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+            slot.end_ns.store(end_ns, std::memory_order_relaxed);
+            slot.sequence.store(next + 1, std::memory_order_release);
+
+            buffer.next.store(next + 1, std::memory_order_release);
+        }
+
+        // Closes the current frame: the time every thread's zones took since the last call is added up per phase and
+        // becomes the newest entry of the history the percentiles are taken from. Call it from one thread only.
+        void endFrame()
+        {
+            const std::size_t slot = frame_count++ % history_frames;
+            for (PhaseHistory &phase : phases)
+            {
+                phase.frame_ms[slot] = 0.0f;
+            }
+
+            const std::lock_guard lock{buffers_mutex};
+            for (const std::unique_ptr<ThreadBuffer> &buffer : buffers)
+            {
+                const std::size_t end = buffer->next.load(std::memory_order_acquire);
+                const std::size_t begin = std::max(buffer->frame_begin, end - std::min(end, zone_capacity));
+                buffer->frame_begin = end;
+
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    if (const std::optional<Zone> zone = readZone(*buffer, i))
+                    {
+                        findPhase(zone->name).frame_ms[slot] += static_cast<float>(zone->end_ns - zone->begin_ns)
+                                                                / 1e6f;
+                    }
+                }
+            }
+        }
+
+        // p50 and p99 of every phase's time per frame over the last history_frames frames
+        [[nodiscard]] std::vector<PhaseStats> getPhaseStats() const
+        {
+            const std::size_t frames = std::min(frame_count, history_frames);
+
+            std::vector<PhaseStats> stats;
+            std::vector<float> samples;
+            for (const PhaseHistory &phase : phases)
+            {
+                samples.assign(phase.frame_ms.begin(), phase.frame_ms.begin() + frames);
+                stats.push_back({phase.name, percentile(samples, 0.50), percentile(samples, 0.99)});
+            }
+
+            return stats;
+        }
+
+        // Writes every thread's buffered zones in the Chrome trace event format, viewable in chrome://tracing or
+        // Perfetto. Zones other threads overwrite while the trace is written are left out.
+        bool writeChromeTrace(const std::filesystem::path &path) const
+        {
+            std::ofstream file{path, std::ios::trunc};
+            if (!file)
+            {
+                return false;
+            }
+
+            file << "{\"traceEvents\":[";
+
+            bool first = true;
+            const std::lock_guard lock{buffers_mutex};
+            for (const std::unique_ptr<ThreadBuffer> &buffer : buffers)
+            {
+                const std::size_t end = buffer->next.load(std::memory_order_acquire);
+                for (std::size_t i = end - std::min(end, zone_capacity); i < end; ++i)
+                {
+                    const std::optional<Zone> zone = readZone(*buffer, i);
+                    if (!zone)
+                    {
+                        continue;
+                    }
+
+                    file << (first ? "\n" : ",\n")
+                            << R"({"name":")" << zone->name << R"(","ph":"X","pid":0,"tid":)" << buffer->thread_id
+                            << R"(,"ts":)" << zone->begin_ns / 1000.0 << R"(,"dur":)"
+                            << (zone->end_ns - zone->begin_ns) / 1000.0 << "}";
+                    first = false;
+                }
+            }
+
+            file << "\n]}\n";
+
+            return static_cast<bool>(file);
+        }
+
+    private:
+        // The zone with the given index, nothing if its slot has been reused or is being written meanwhile
+        static std::optional<Zone> readZone(const ThreadBuffer &buffer, const std::size_t index)
+        {
+            const Slot &slot = buffer.slots[index % zone_capacity];
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+            {
+                return std::nullopt;
+            }
+
+            const Zone zone{
+                slot.name.load(std::memory_order_relaxed),
+                slot.begin_ns.load(std::memory_order_relaxed),
+                slot.end_ns.load(std::memory_order_relaxed)
+            };
+
+            // A writer that got to the slot since would have reset the sequence before changing any field
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != index + 1)
+            {
+                return std::nullopt;
+            }
+
+            return zone;
+        }
+
+        ThreadBuffer &getThreadBuffer()
+        {
+            if (!thread_buffer)
+            {
+                const std::lock_guard lock{buffers_mutex};
+                thread_buffer = buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+                thread_buffer->thread_id = static_cast<unsigned int>(buffers.size() - 1);
+            }
+
+            return *thread_buffer;
+        }
+
+        PhaseHistory &findPhase(const char *name)
+        {
+            // A handful of phases, a linear search beats hashing here
+            for (PhaseHistory &phase : phases)
+            {
+                if (phase.name == name)
+                {
+                    return phase;
+                }
+            }
+
+            return phases.emplace_back(PhaseHistory{name});
+        }
+
+        static double percentile(std::vector<float> &samples, const double fraction)
+        {
+            if (samples.empty())
+            {
+                return 0.0;
+            }
+
+            const auto nth = samples.begin() + static_cast<std::ptrdiff_t>(fraction * (samples.size() - 1));
+            std::nth_element(samples.begin(), nth, samples.end());
+            return *nth;
+        }
+};
+
+// Records the scope it lives in as one zone
+class ProfileZone final
+{
+    const char *name;
+    const std::int64_t begin_ns;
+
+    public:
+        explicit ProfileZone(const char *name) : name(name), begin_ns(Profiler::instance().now())
+        {
+        }
+
+        ProfileZone(const ProfileZone &) = delete;
+        ProfileZone &operator=(const ProfileZone &) = delete;
+
+        ~ProfileZone()
+        {
+            Profiler &profiler = Profiler::instance();
+            profiler.record(name, begin_ns, profiler.now());
+        }
+};
+
+#ifdef SPACE_INVADERS_PROFILE
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+// name must be a string literal
+#define PROFILE_ZONE(name) const ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__){name}
+#else
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#endif
+
+#endif //PROFILER_H
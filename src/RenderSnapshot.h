@@ -0,0 +1,88 @@
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "Simulation.h"
+#include "TextureAtlas.h"
+
+// Everything the renderer needs of one simulation tick, copied out so it can be drawn while the simulation moves on
+struct RenderSnapshot
+{
+    struct Sprite
+    {
+        TextureAtlas::Handle region;
+        // Where the sprite was a tick earlier, equal to position for sprites that aren't interpolated
+        sf::Vector2f previous_position;
+        sf::Vector2f position;
+        sf::Vector2f scale;
+    };
+
+    // Counts every change of a barrier's image and remembers the area of the latest ones, so a copy of the image
+    // that is a few revisions behind can be brought up to date by copying only what changed
+    struct BarrierDamage
+    {
+        static constexpr std::size_t history = 16;
+
+        std::uint64_t revision = 0;
+        // The area changed by revision r is at r % history
+        std::array<sf::IntRect, history> areas{};
+
+        void add(const sf::IntRect &area)
+        {
+            areas[++revision % history] = area;
+        }
+
+        // Bounding box of the changes after revision since, full_area if they're no longer all remembered
+        [[nodiscard]] sf::IntRect changedSince(const std::uint64_t since, const sf::IntRect &full_area) const
+        {
+            if (revision - since > history)
+            {
+                return full_area;
+            }
+
+            sf::Vector2i min = areas[revision % history].position;
+            sf::Vector2i max = min + areas[revision % history].size;
+            for (std::uint64_t r = since + 1; r < revision; ++r)
+            {
+                const sf::IntRect &area = areas[r % history];
+                min = {std::min(min.x, area.position.x), std::min(min.y, area.position.y)};
+                max = {std::max(max.x, area.position.x + area.size.x), std::max(max.y, area.position.y + area.size.y)};
+            }
+
+            return {min, max - min};
+        }
+    };
+
+    struct BarrierView
+    {
+        // Up to date at damage.revision, only the changed areas are copied in
+        sf::Image image;
+        BarrierDamage damage;
+        sf::Vector2f position;
+        float scale = 1.0f;
+    };
+
+    // Centered at their positions
+    std::vector<Sprite> sprites{};
+    std::array<BarrierView, Simulation::barrier_count> barriers{};
+
+    int score = 0;
+    int lives = 0;
+    bool game_over = false;
+
+    // Every input event up to this one (see InputQueue) was applied by the time of the snapshot
+    std::uint64_t input_sequence = 0;
+
+    // When the tick was simulated, for interpolating towards the next one
+    std::chrono::steady_clock::time_point tick_time{};
+};
+
+#endif //RENDERSNAPSHOT_H
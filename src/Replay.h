@@ -0,0 +1,254 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "AlienManager.h"
+#include "Input.h"
+
+// A recorded game: the seed and formation it started from, the input of every tick and the outcome a playback
+// has to reproduce. The simulation is deterministic for a given seed and input, so that is all it takes.
+// Input is stored run-length encoded, held keys repeat for many ticks.
+class Replay
+{
+    static constexpr std::array<char, 4> magic = {'S', 'I', 'R', 'P'};
+    static constexpr std::uint16_t format_version = 1;
+    // Guards against allocating absurd formations from a corrupt file
+    static constexpr std::uint64_t max_aliens = AlienManager::Formation::max_aliens;
+
+    struct Run
+    {
+        std::uint8_t input_bits;
+        std::uint32_t length;
+    };
+
+    std::uint32_t seed;
+    AlienManager::Formation formation;
+    std::vector<Run> runs{};
+    std::uint64_t tick_count = 0;
+    std::int32_t final_score = 0;
+    std::uint64_t final_state_hash = 0;
+
+    public:
+        Replay(const std::uint32_t seed, AlienManager::Formation formation) : seed(seed),
+                                                                              formation(std::move(formation))
+        {
+        }
+
+        // Appends the input of the next tick
+        void record(const Input &input)
+        {
+            const std::uint8_t bits = toBits(input);
+            if (!runs.empty() && runs.back().input_bits == bits && runs.back().length != UINT32_MAX)
+            {
+                ++runs.back().length;
+            }
+            else
+            {
+                runs.push_back({bits, 1});
+            }
+
+            ++tick_count;
+        }
+
+        // Stores the outcome after the last recorded tick
+        void finish(const int score, const std::uint64_t state_hash)
+        {
+            final_score = score;
+            final_state_hash = state_hash;
+        }
+
+        // Calls on_tick with the input of every recorded tick, in order
+        template<typename OnTick>
+        void forEachInput(OnTick &&on_tick) const
+        {
+            for (const Run &run : runs)
+            {
+                const Input input = fromBits(run.input_bits);
+                for (std::uint32_t i = 0; i < run.length; ++i)
+                {
+                    on_tick(input);
+                }
+            }
+        }
+
+        [[nodiscard]] std::uint32_t getSeed() const
+        {
+            return seed;
+        }
+
+        [[nodiscard]] const AlienManager::Formation &getFormation() const
+        {
+            return formation;
+        }
+
+        [[nodiscard]] std::uint64_t getTickCount() const
+        {
+            return tick_count;
+        }
+
+        [[nodiscard]] int getFinalScore() const
+        {
+            return final_score;
+        }
+
+        [[nodiscard]] std::uint64_t getFinalStateHash() const
+        {
+            return final_state_hash;
+        }
+
+        // Little endian, integers in the run list are LEB128 varints
+        bool save(const std::filesystem::path &path) const
+        {
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            if (!file)
+            {
+                return false;
+            }
+
+            file.write(magic.data(), magic.size());
+            writeFixed(file, format_version);
+            writeFixed(file, seed);
+            writeFixed(file, formation.rows);
+            writeFixed(file, formation.cols);
+            for (const Alien::Type type : formation.row_types)
+            {
+                writeFixed(file, static_cast<std::uint8_t>(Alien::getScore(type)));
+            }
+            writeFixed(file, tick_count);
+            writeFixed(file, final_score);
+            writeFixed(file, final_state_hash);
+
+            writeVarint(file, runs.size());
+            for (const Run &run : runs)
+            {
+                writeFixed(file, run.input_bits);
+                writeVarint(file, run.length);
+            }
+
+            return static_cast<bool>(file);
+        }
+
+        // Returns nothing if the file can't be read or isn't a replay of this format version
+        static std::optional<Replay> load(const std::filesystem::path &path)
+        {
+            std::ifstream file{path, std::ios::binary};
+
+            std::array<char, 4> file_magic{};
+            file.read(file_magic.data(), file_magic.size());
+            if (!file || file_magic != magic || readFixed<std::uint16_t>(file) != format_version)
+            {
+                return std::nullopt;
+            }
+
+            const auto replay_seed = readFixed<std::uint32_t>(file);
+            const auto rows = readFixed<std::uint32_t>(file);
+            const auto cols = readFixed<std::uint32_t>(file);
+            if (rows == 0 || cols == 0 || std::uint64_t{rows} * cols > max_aliens)
+            {
+                return std::nullopt;
+            }
+
+            AlienManager::Formation replay_formation{rows, cols, {}};
+            for (unsigned int row = 0; row < rows && file; ++row)
+            {
+                const auto type = static_cast<Alien::Type>(readFixed<std::uint8_t>(file));
+                if (type != Alien::Type::A && type != Alien::Type::B && type != Alien::Type::C)
+                {
+                    return std::nullopt;
+                }
+
+                replay_formation.row_types.push_back(type);
+            }
+
+            Replay replay{replay_seed, std::move(replay_formation)};
+            replay.tick_count = readFixed<std::uint64_t>(file);
+            replay.final_score = readFixed<std::int32_t>(file);
+            replay.final_state_hash = readFixed<std::uint64_t>(file);
+
+            std::uint64_t recorded_ticks = 0;
+            const std::uint64_t run_count = readVarint(file);
+            for (std::uint64_t i = 0; i < run_count && file; ++i)
+            {
+                const auto bits = readFixed<std::uint8_t>(file);
+                const auto length = static_cast<std::uint32_t>(readVarint(file));
+                replay.runs.push_back({bits, length});
+                recorded_ticks += length;
+            }
+
+            if (!file || recorded_ticks != replay.tick_count)
+            {
+                return std::nullopt;
+            }
+
+            return replay;
+        }
+
+    private:
+        static std::uint8_t toBits(const Input &input)
+        {
+            return static_cast<std::uint8_t>(input.left | (input.right << 1) | (input.shoot << 2));
+        }
+
+        static Input fromBits(const std::uint8_t bits)
+        {
+            return Input{(bits & 1) != 0, (bits & 2) != 0, (bits & 4) != 0};
+        }
+
+        template<typename T>
+        static void writeFixed(std::ostream &stream, const T value)
+        {
+            for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+            {
+                stream.put(static_cast<char>((static_cast<std::uint64_t>(value) >> byte * 8) & 0xFF));
+            }
+        }
+
+        template<typename T>
+        static T readFixed(std::istream &stream)
+        {
+            std::uint64_t value = 0;
+            for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+            {
+                value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(stream.get())) << byte * 8;
+            }
+
+            return static_cast<T>(value);
+        }
+
+        static void writeVarint(std::ostream &stream, std::uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                stream.put(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            stream.put(static_cast<char>(value));
+        }
+
+        static std::uint64_t readVarint(std::istream &stream)
+        {
+            std::uint64_t value = 0;
+            for (unsigned int shift = 0; shift < 64 && stream; shift += 7)
+            {
+                const auto byte = static_cast<std::uint8_t>(stream.get());
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                {
+                    break;
+                }
+            }
+
+            return value;
+        }
+};
+
+#endif //REPLAY_H
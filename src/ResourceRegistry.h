@@ -0,0 +1,140 @@
+#ifndef RESOURCEREGISTRY_H
+#define RESOURCEREGISTRY_H
+
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+
+#include <SFML/Graphics.hpp>
+
+// Shared, read-only reference to a loaded resource. Copying one is cheap, the resource is freed with the last one.
+template<typename Resource>
+using ResourceHandle = std::shared_ptr<const Resource>;
+
+// Keeps track of every loaded asset by its ID (its path below the assets directory, e.g. "images/bullet.png") so
+// each is loaded once and shared through handles. The registry itself doesn't keep resources alive, an entry whose
+// last handle is gone no longer counts as resident and is replaced when the ID is added again.
+class ResourceRegistry
+{
+    struct Entry
+    {
+        std::type_index type;
+        const char *kind;
+        // Empty for resources owned outside the registry, which are always listed as resident
+        std::weak_ptr<const void> resource;
+        bool owned;
+        std::size_t cpu_bytes;
+        std::size_t gpu_bytes;
+    };
+
+    // Sorted so the report is too
+    std::map<std::string, Entry, std::less<>> entries{};
+
+    public:
+        // The resource registered under id, empty if there is none or it has been freed.
+        // Throws if id refers to a resource of another type.
+        template<typename Resource>
+        [[nodiscard]] ResourceHandle<Resource> find(const std::string_view id) const
+        {
+            const auto entry = entries.find(id);
+            if (entry == entries.end() || !entry->second.owned)
+            {
+                return nullptr;
+            }
+
+            if (entry->second.type != std::type_index{typeid(Resource)})
+            {
+                throw std::logic_error("Resource " + std::string{id} + " has a different type");
+            }
+
+            return std::static_pointer_cast<const Resource>(entry->second.resource.lock());
+        }
+
+        // Shares resource under id and returns a handle to it. If a resource is still alive under id, that one is
+        // returned instead and resource is dropped. cpu_bytes is what the resource keeps in memory.
+        template<typename Resource>
+        ResourceHandle<Resource> add(std::string id, Resource resource, const std::size_t cpu_bytes)
+        {
+            if (ResourceHandle<Resource> existing = find<Resource>(id))
+            {
+                return existing;
+            }
+
+            auto handle = std::make_shared<const Resource>(std::move(resource));
+            entries.insert_or_assign(std::move(id),
+                                     Entry{typeid(Resource), kindName<Resource>(), handle, true, cpu_bytes, 0});
+            return handle;
+        }
+
+        // Records a resource that lives elsewhere (e.g. a sound buffer owned by the audio backend, or a texture with
+        // the video memory its upload takes) for the report
+        void track(std::string id, const char *kind, const std::size_t cpu_bytes, const std::size_t gpu_bytes)
+        {
+            entries.insert_or_assign(std::move(id), Entry{typeid(void), kind, {}, false, cpu_bytes, gpu_bytes});
+        }
+
+        // One line per resident resource with its size and number of handles, then the totals
+        void report(std::ostream &stream) const
+        {
+            std::size_t total_cpu_bytes = 0;
+            std::size_t total_gpu_bytes = 0;
+            std::array<char, 160> line{};
+
+            std::snprintf(line.data(), line.size(), "%-32s %-8s %12s %12s %8s\n", "Resource", "Kind", "CPU bytes",
+                          "GPU bytes", "Handles");
+            stream << line.data();
+            for (const auto &[id, entry] : entries)
+            {
+                const long handles = entry.resource.use_count();
+                if (entry.owned && handles == 0)
+                {
+                    continue;
+                }
+
+                std::snprintf(line.data(), line.size(), "%-32s %-8s %12zu %12zu %8s\n", id.c_str(), entry.kind,
+                              entry.cpu_bytes, entry.gpu_bytes,
+                              entry.owned ? std::to_string(handles).c_str() : "-");
+                stream << line.data();
+
+                total_cpu_bytes += entry.cpu_bytes;
+                total_gpu_bytes += entry.gpu_bytes;
+            }
+
+            std::snprintf(line.data(), line.size(), "%-32s %-8s %12zu %12zu\n", "Total", "", total_cpu_bytes,
+                          total_gpu_bytes);
+            stream << line.data();
+        }
+
+    private:
+        template<typename Resource>
+        static const char *kindName()
+        {
+            if constexpr (std::is_same_v<Resource, sf::Image>)
+            {
+                return "image";
+            }
+            else if constexpr (std::is_same_v<Resource, sf::Font>)
+            {
+                return "font";
+            }
+            else if constexpr (std::is_same_v<Resource, sf::Texture>)
+            {
+                return "texture";
+            }
+            else
+            {
+                return "other";
+            }
+        }
+};
+
+#endif //RESOURCEREGISTRY_H
@@ -0,0 +1,413 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "AlienManager.h"
+#include "Barrier.h"
+#include "BulletManager.h"
+#include "Input.h"
+#include "Profiler.h"
+#include "SpatialGrid.h"
+#include "Spaceship.h"
+#include "SpriteImages.h"
+
+// The whole game state and rules, without any window, GL context or audio device.
+// A front end feeds it Input and reacts to the Events returned from step().
+class Simulation
+{
+    public:
+        static constexpr int world_x = 1920;
+        static constexpr int world_y = 1080;
+
+        // Length of one simulation step. Speeds are tuned in pixels per millisecond, and the rate matches the
+        // refresh rate the game was originally balanced at.
+        static constexpr int tick_rate = 144;
+        static constexpr float tick_ms = 1000.0f / tick_rate;
+
+        static constexpr float player_bullet_speed = 1.2f;
+        static constexpr float enemy_bullet_speed = 0.5f;
+        static constexpr sf::Vector2f bullet_scale = {5.0f, 12.5f};
+        static constexpr std::size_t max_alien_bullets = 10;
+
+        static constexpr float spaceship_speed = 0.8f;
+        static constexpr float spaceship_scale = 4.0f;
+        static constexpr sf::Vector2f spaceship_pos = {world_x / 2.0f, world_y - 0.1f * world_y};
+
+        static constexpr float alien_move_interval = 500.0f;
+        static constexpr float alien_speed = 5.0f;
+        static constexpr float alien_step_down = 5.0f;
+        // Formations too large to fit at this scale are shrunk, see AlienManager::getScale()
+        static constexpr float alien_scale = 3.0f;
+
+        static constexpr float barrier_scale = 8.0f;
+        static constexpr std::size_t barrier_count = 4;
+
+        static constexpr float collision_cell_size = 128.0f;
+
+        // Broad phase work done by the last step
+        struct CollisionStats
+        {
+            std::size_t queries = 0;
+            std::size_t pairs_tested = 0;
+        };
+
+        // Things that happened during a step, so the front end can play sounds or pause
+        enum Event : unsigned int
+        {
+            None = 0,
+            PlayerShot = 1 << 0,
+            PlayerHit = 1 << 1,
+            AlienKilled = 1 << 2,
+            AliensMoved = 1 << 3,
+            LevelCleared = 1 << 4
+        };
+
+    private:
+        // FNV-1a over the bytes of the added values
+        struct StateHash
+        {
+            std::uint64_t value = 14695981039346656037ull;
+
+            template<typename T>
+            void add(const T &item)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+
+                std::array<unsigned char, sizeof(T)> bytes{};
+                std::memcpy(bytes.data(), &item, sizeof(T));
+                for (const unsigned char byte : bytes)
+                {
+                    value = (value ^ byte) * 1099511628211ull;
+                }
+            }
+        };
+
+        BulletManager bullet_manager;
+        Spaceship spaceship;
+        AlienManager alien_manager;
+        std::array<Barrier, barrier_count> barriers;
+
+        // Kinds of colliders registered in collision_grid
+        enum Collider : std::uint8_t
+        {
+            SpaceshipCollider,
+            FormationCollider,
+            BarrierCollider
+        };
+
+        SpatialGrid collision_grid{{0.0f, 0.0f}, {world_x, world_y}, collision_cell_size};
+        // Alien revision the static grid layer was built for
+        std::optional<unsigned int> grid_alien_revision{};
+        std::vector<SpatialGrid::Id> collision_candidates{};
+        CollisionStats collision_stats{};
+
+        int score = 0;
+        // Starts at 1, advances whenever the formation is cleared
+        int level = 1;
+
+    public:
+        Simulation(const SpriteImages &images,
+                   const std::uint32_t seed,
+                   const AlienManager::Formation &formation = AlienManager::Formation::make()) :
+            bullet_manager{
+                images.bullet->getSize(), 0, world_y, player_bullet_speed, enemy_bullet_speed, max_alien_bullets
+            },
+            spaceship{images.spaceship->getSize(), spaceship_speed, spaceship_scale, spaceship_pos, 0.0f, world_x},
+            alien_manager{
+                {images.aliens[0][0]->getSize(), images.aliens[1][0]->getSize(), images.aliens[2][0]->getSize()},
+                {0.05f * world_x, 0.1f * world_y}, {0.95f * world_x, 0.7f * world_y},
+                alien_speed, alien_move_interval, alien_step_down, alien_scale, seed, formation
+            },
+            barriers{
+                Barrier{images.barrier, barrier_scale, {0.15f * world_x, 0.65f * world_y}, seed},
+                Barrier{images.barrier, barrier_scale, {0.35f * world_x, 0.65f * world_y}, seed},
+                Barrier{images.barrier, barrier_scale, {0.55f * world_x, 0.65f * world_y}, seed},
+                Barrier{images.barrier, barrier_scale, {0.75f * world_x, 0.65f * world_y}, seed}
+            }
+        {
+            reset(seed);
+        }
+
+        // Starts a fresh game. The same seed always produces the same game for the same inputs.
+        void reset(const std::uint32_t seed)
+        {
+            // One independent stream per random engine
+            std::array<std::uint32_t, 1 + barrier_count> seeds{};
+            std::seed_seq seq{seed};
+            seq.generate(seeds.begin(), seeds.end());
+
+            spaceship.restart();
+            bullet_manager.restart();
+            alien_manager.restart();
+            alien_manager.reseed(seeds[0]);
+
+            for (std::size_t i = 0; i < barrier_count; ++i)
+            {
+                barriers[i].restart(seeds[i + 1]);
+            }
+
+            score = 0;
+            level = 1;
+        }
+
+        // Advances the game by delta_time milliseconds, normally tick_ms. Returns a mask of Event values.
+        unsigned int step(const Input &input, const float delta_time = tick_ms)
+        {
+            unsigned int events = None;
+
+            spaceship.beginStep();
+
+            if (input.shoot && spaceship.shoot(bullet_manager))
+            {
+                events |= PlayerShot;
+            }
+
+            if (alien_manager.allAliensDead())
+            {
+                nextLevel();
+                events |= LevelCleared;
+            }
+
+            if (input.left)
+            {
+                spaceship.move_left(delta_time);
+            }
+
+            if (input.right)
+            {
+                spaceship.move_right(delta_time);
+            }
+
+            if (alien_manager.update(delta_time, bullet_manager))
+            {
+                events |= AliensMoved;
+            }
+
+            bullet_manager.move(delta_time);
+
+            events |= handleCollisions();
+
+            return events;
+        }
+
+        [[nodiscard]] bool isGameOver() const
+        {
+            return spaceship.isDead();
+        }
+
+        [[nodiscard]] int getScore() const
+        {
+            return score;
+        }
+
+        [[nodiscard]] int getLevel() const
+        {
+            return level;
+        }
+
+        [[nodiscard]] const CollisionStats &getCollisionStats() const
+        {
+            return collision_stats;
+        }
+
+        // Fingerprint of everything that affects how the game continues, for checking that a replay reproduced
+        // the recorded game. Floats are hashed by their bits, so it's only comparable between identical builds.
+        [[nodiscard]] std::uint64_t getStateHash() const
+        {
+            StateHash hash;
+            hash.add(score);
+            hash.add(spaceship.getLives());
+            hash.add(spaceship.getPosition());
+
+            hash.add(alien_manager.getFormationBounds().position);
+            for (unsigned int i = 0, e = alien_manager.getCount(); i < e; ++i)
+            {
+                hash.add(alien_manager.getState(i));
+            }
+
+            for (const Bullet &bullet : bullet_manager.alien_bullets)
+            {
+                hash.add(bullet.getPosition());
+            }
+            hash.add(bullet_manager.player_bullet.has_value());
+            if (bullet_manager.player_bullet)
+            {
+                hash.add(bullet_manager.player_bullet->getPosition());
+            }
+
+            for (const Barrier &barrier : barriers)
+            {
+                const sf::Vector2i size{barrier.getImage().getSize()};
+                for (int y = 0; y < size.y; ++y)
+                {
+                    for (int x = 0; x < size.x; ++x)
+                    {
+                        hash.add(barrier.isSolid({x, y}));
+                    }
+                }
+            }
+
+            return hash.value;
+        }
+
+        [[nodiscard]] const Spaceship &getSpaceship() const
+        {
+            return spaceship;
+        }
+
+        [[nodiscard]] const AlienManager &getAlienManager() const
+        {
+            return alien_manager;
+        }
+
+        [[nodiscard]] const BulletManager &getBulletManager() const
+        {
+            return bullet_manager;
+        }
+
+        [[nodiscard]] const std::array<Barrier, barrier_count> &getBarriers() const
+        {
+            return barriers;
+        }
+
+        // Non-const access so a renderer can take the barriers' dirty rectangles
+        [[nodiscard]] std::array<Barrier, barrier_count> &getBarriers()
+        {
+            return barriers;
+        }
+
+    private:
+        // The formation and barriers only change when the formation steps or an alien dies, so they sit in the
+        // static layer and are re-registered only then. The spaceship moves every step and is in the dynamic layer.
+        void updateCollisionGrid()
+        {
+            if (grid_alien_revision != alien_manager.getRevision())
+            {
+                collision_grid.clear(SpatialGrid::Layer::Static);
+
+                // The formation resolves hits on its own lattice, the grid only needs its outline
+                collision_grid.insert(SpatialGrid::Layer::Static,
+                                      SpatialGrid::makeId(FormationCollider, 0),
+                                      alien_manager.getFormationBounds());
+
+                for (std::uint32_t i = 0; i < barrier_count; ++i)
+                {
+                    collision_grid.insert(SpatialGrid::Layer::Static,
+                                          SpatialGrid::makeId(BarrierCollider, i),
+                                          barriers[i].getBounds());
+                }
+
+                grid_alien_revision = alien_manager.getRevision();
+            }
+
+            collision_grid.clear(SpatialGrid::Layer::Dynamic);
+            collision_grid.insert(SpatialGrid::Layer::Dynamic,
+                                  SpatialGrid::makeId(SpaceshipCollider, 0),
+                                  spaceship.getBounds());
+        }
+
+        // Area a bullet can touch: its hit edge, widened by a pixel like the exact tests do
+        static sf::FloatRect getQueryArea(const Bullet &bullet)
+        {
+            const sf::Vector2f upper_left = bullet.getUpperLeft();
+            const sf::Vector2f upper_right = bullet.getUpperRight();
+            return {{upper_left.x - 1.0f, upper_left.y}, {upper_right.x - upper_left.x + 2.0f, 1.0f}};
+        }
+
+        // Finds the first candidate (by kind, then index) the bullet really hits and applies the hit.
+        // Returns the kind that was hit, if any.
+        std::optional<Collider> collide(const Bullet &bullet, const std::uint32_t kind_mask)
+        {
+            collision_grid.query(getQueryArea(bullet), kind_mask, collision_candidates);
+            ++collision_stats.queries;
+
+            for (const SpatialGrid::Id id : collision_candidates)
+            {
+                ++collision_stats.pairs_tested;
+
+                const std::uint32_t index = SpatialGrid::getIndex(id);
+                switch (const auto kind = static_cast<Collider>(SpatialGrid::getKind(id)))
+                {
+                    case SpaceshipCollider:
+                        if (spaceship.handleCollision(bullet))
+                        {
+                            return kind;
+                        }
+                        break;
+
+                    case FormationCollider:
+                        if (const int value = alien_manager.handleCollision(bullet); value != 0)
+                        {
+                            score += value;
+                            return kind;
+                        }
+                        break;
+
+                    case BarrierCollider:
+                        if (barriers[index].handleCollision(bullet))
+                        {
+                            return kind;
+                        }
+                        break;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        // Returns PlayerHit and/or AlienKilled
+        unsigned int handleCollisions()
+        {
+            PROFILE_ZONE("Collisions");
+
+            collision_stats = {};
+            updateCollisionGrid();
+
+            unsigned int events = None;
+            if (const auto &player_bullet = bullet_manager.player_bullet)
+            {
+                constexpr std::uint32_t player_bullet_targets = 1 << FormationCollider | 1 << BarrierCollider;
+                if (const std::optional<Collider> hit = collide(*player_bullet, player_bullet_targets))
+                {
+                    if (*hit == FormationCollider)
+                    {
+                        events |= AlienKilled;
+                    }
+
+                    bullet_manager.erasePlayerBullet();
+                }
+            }
+
+            constexpr std::uint32_t alien_bullet_targets = 1 << SpaceshipCollider | 1 << BarrierCollider;
+            for (std::size_t i = 0, e = bullet_manager.alien_bullets.size(); i < e; ++i)
+            {
+                if (const std::optional<Collider> hit = collide(bullet_manager.alien_bullets[i], alien_bullet_targets))
+                {
+                    if (*hit == SpaceshipCollider)
+                    {
+                        events |= PlayerHit;
+                    }
+
+                    bullet_manager.eraseAlienBullet(i);
+                }
+            }
+            bullet_manager.flushAlienBullets();
+
+            return events;
+        }
+
+        void nextLevel()
+        {
+            ++level;
+            bullet_manager.restart();
+            alien_manager.restart();
+        }
+};
+
+#endif //SIMULATION_H
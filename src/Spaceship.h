@@ -5,10 +5,11 @@
 
 #include "BulletManager.h"
 
-class Spaceship final : public sf::Drawable
+class Spaceship final
 {
-    const sf::Texture texture;
-    sf::Sprite sprite;
+    sf::Vector2f position;
+    sf::Vector2f previous_position;
+    sf::Vector2f size;
     const float speed;
     int lives = 3;
     const sf::Vector2f original_pos;
@@ -17,65 +18,48 @@ class Spaceship final : public sf::Drawable
 
     float half_tex_size;
 
-    const sf::SoundBuffer shoot_sound_buffer{"../../assets/sounds/shoot.wav"};
-    sf::Sound shoot_sound{shoot_sound_buffer};
-    const sf::SoundBuffer explosion_sound_buffer{"../../assets/sounds/explosion.wav"};
-    sf::Sound explosion_sound{explosion_sound_buffer};
-
     public:
-        Spaceship(const std::filesystem::path &filename,
+        Spaceship(const sf::Vector2u &texture_size,
                   const float speed,
                   const float scale,
                   const sf::Vector2f &pos,
                   const float min_x,
-                  const float max_x): texture(filename), sprite(texture), speed(speed), original_pos(pos), min_x(min_x),
-                                      max_x(max_x)
+                  const float max_x): position(pos), previous_position(pos),
+                                      size(sf::Vector2f(texture_size) * scale), speed(speed), original_pos(pos),
+                                      min_x(min_x), max_x(max_x)
 
         {
-            //Set origin to center
-            sprite.setOrigin({
-                static_cast<float>(texture.getSize().x) / 2.0f, static_cast<float>(texture.getSize().y) / 2.0f
-            });
-
-            sprite.setScale({scale, scale});
-
-            sprite.setPosition(pos);
-
-            half_tex_size = texture.getSize().x * scale / 2.0f;
-
-            shoot_sound.setVolume(30.0f);
-            explosion_sound.setVolume(30.0f);
+            half_tex_size = texture_size.x * scale / 2.0f;
         }
 
-        void draw(sf::RenderTarget &target, const sf::RenderStates states) const override
+        // Remembers where the spaceship was at the start of a step, for interpolated rendering
+        void beginStep()
         {
-            target.draw(sprite, states);
+            previous_position = position;
         }
 
-        void move_left(const std::int32_t delta_time)
+        void move_left(const float delta_time)
         {
-            if (sprite.getPosition().x - half_tex_size >= min_x)
+            if (position.x - half_tex_size >= min_x)
             {
                 const float distance = -speed * delta_time;
-                sprite.move({distance, 0.0f});
+                position.x += distance;
             }
         }
 
-        void move_right(const std::int32_t delta_time)
+        void move_right(const float delta_time)
         {
-            if (sprite.getPosition().x + half_tex_size <= max_x)
+            if (position.x + half_tex_size <= max_x)
             {
                 const float distance = speed * delta_time;
-                sprite.move({distance, 0.0f});
+                position.x += distance;
             }
         }
 
-        void shoot(BulletManager &bullet_manager)
+        // Returns true if a bullet was fired
+        bool shoot(BulletManager &bullet_manager) const
         {
-            if (bullet_manager.addBullet(sprite.getPosition(), Bullet::Type::Player))
-            {
-                shoot_sound.play();
-            }
+            return bullet_manager.addBullet(position, Bullet::Type::Player);
         }
 
         [[nodiscard]] bool handleCollision(const Bullet &bullet)
@@ -89,18 +73,34 @@ class Spaceship final : public sf::Drawable
             ++upper_right.x;
             ++upper_right.y;
 
-            const bool isHit = sprite.getGlobalBounds().contains(upper_left) || sprite.getGlobalBounds().contains(
-                upper_right);
+            const sf::FloatRect bounds = getBounds();
+            const bool isHit = bounds.contains(upper_left) || bounds.contains(upper_right);
 
             if (isHit)
             {
                 --lives;
-                explosion_sound.play();
             }
 
             return isHit;
         }
 
+        // Position of the spaceship's centre
+        [[nodiscard]] sf::Vector2f getPosition() const
+        {
+            return position;
+        }
+
+        // Position between the previous and the current step, alpha in [0, 1]
+        [[nodiscard]] sf::Vector2f getInterpolatedPosition(const float alpha) const
+        {
+            return previous_position + (position - previous_position) * alpha;
+        }
+
+        [[nodiscard]] sf::FloatRect getBounds() const
+        {
+            return {position - size / 2.0f, size};
+        }
+
         [[nodiscard]] bool isDead() const
         {
             return lives <= 0;
@@ -114,7 +114,8 @@ class Spaceship final : public sf::Drawable
         void restart()
         {
             lives = 3;
-            sprite.setPosition(original_pos);
+            position = original_pos;
+            previous_position = original_pos;
         }
 };
 
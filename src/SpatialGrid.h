@@ -0,0 +1,162 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+// Uniform grid broad phase. Colliders are inserted with their bounding boxes, queries return the colliders whose
+// cells overlap an area so only those need an exact (narrow phase) test.
+// Colliders live in one of two layers: the static layer is only rebuilt when its colliders change, the dynamic
+// layer is meant to be cleared and refilled every step. Each layer is a singly linked list per cell in flat
+// arrays, so rebuilding doesn't allocate once warm.
+class SpatialGrid
+{
+    public:
+        // Identifies a collider: the kind in the top byte and an index within that kind below it.
+        // Sorting ids therefore orders candidates by kind, then by index.
+        using Id = std::uint32_t;
+
+        static constexpr Id makeId(const std::uint8_t kind, const std::uint32_t index)
+        {
+            return static_cast<Id>(kind) << 24 | index;
+        }
+
+        static constexpr std::uint8_t getKind(const Id id)
+        {
+            return static_cast<std::uint8_t>(id >> 24);
+        }
+
+        static constexpr std::uint32_t getIndex(const Id id)
+        {
+            return id & 0x00FFFFFF;
+        }
+
+        enum class Layer
+        {
+            Static,
+            Dynamic
+        };
+
+    private:
+        struct Entry
+        {
+            Id id;
+            int next;
+        };
+
+        struct Cells
+        {
+            std::vector<int> heads;
+            std::vector<Entry> entries{};
+            // Cells with at least one entry, so clearing a sparse layer only touches those
+            std::vector<int> used{};
+        };
+
+        const sf::Vector2f origin;
+        const float cell_size;
+        const sf::Vector2i cell_count;
+
+        std::array<Cells, 2> layers;
+
+    public:
+        // Covers the rectangle from origin with size world_size, anything outside is clamped to the border cells
+        SpatialGrid(const sf::Vector2f &origin, const sf::Vector2f &world_size, const float cell_size) :
+            origin(origin), cell_size(cell_size),
+            cell_count(static_cast<int>(std::ceil(world_size.x / cell_size)),
+                       static_cast<int>(std::ceil(world_size.y / cell_size))),
+            layers{
+                Cells{std::vector<int>(cell_count.x * cell_count.y, -1)},
+                Cells{std::vector<int>(cell_count.x * cell_count.y, -1)}
+            }
+        {
+        }
+
+        void clear(const Layer layer)
+        {
+            Cells &cells = layers[static_cast<std::size_t>(layer)];
+            for (const int cell : cells.used)
+            {
+                cells.heads[cell] = -1;
+            }
+            cells.used.clear();
+            cells.entries.clear();
+        }
+
+        void insert(const Layer layer, const Id id, const sf::FloatRect &bounds)
+        {
+            Cells &cells = layers[static_cast<std::size_t>(layer)];
+            const auto [min, max] = getCellRange(bounds);
+
+            for (int y = min.y; y <= max.y; ++y)
+            {
+                for (int x = min.x; x <= max.x; ++x)
+                {
+                    const int cell = y * cell_count.x + x;
+                    int &head = cells.heads[cell];
+                    if (head == -1)
+                    {
+                        cells.used.push_back(cell);
+                    }
+
+                    cells.entries.push_back({id, head});
+                    head = static_cast<int>(cells.entries.size()) - 1;
+                }
+            }
+        }
+
+        // Fills candidates with the ids of colliders whose kind is in kind_mask (bit 1 << kind) and whose cells
+        // overlap area. The result is sorted and free of duplicates.
+        void query(const sf::FloatRect &area, const std::uint32_t kind_mask, std::vector<Id> &candidates) const
+        {
+            candidates.clear();
+
+            const auto [min, max] = getCellRange(area);
+            for (int y = min.y; y <= max.y; ++y)
+            {
+                for (int x = min.x; x <= max.x; ++x)
+                {
+                    for (const Cells &cells : layers)
+                    {
+                        const std::vector<Entry> &entries = cells.entries;
+                        for (int entry = cells.heads[y * cell_count.x + x]; entry != -1; entry = entries[entry].next)
+                        {
+                            if (kind_mask >> getKind(entries[entry].id) & 1)
+                            {
+                                candidates.push_back(entries[entry].id);
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (candidates.size() > 1)
+            {
+                std::sort(candidates.begin(), candidates.end());
+                candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            }
+        }
+
+    private:
+        // Inclusive range of cells overlapped by bounds
+        [[nodiscard]] std::pair<sf::Vector2i, sf::Vector2i> getCellRange(const sf::FloatRect &bounds) const
+        {
+            return {toCell(bounds.position), toCell(bounds.position + bounds.size)};
+        }
+
+        [[nodiscard]] sf::Vector2i toCell(const sf::Vector2f &point) const
+        {
+            const sf::Vector2f local = (point - origin) / cell_size;
+            return {
+                std::clamp(static_cast<int>(std::floor(local.x)), 0, cell_count.x - 1),
+                std::clamp(static_cast<int>(std::floor(local.y)), 0, cell_count.y - 1)
+            };
+        }
+};
+
+#endif //SPATIALGRID_H
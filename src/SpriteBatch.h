@@ -0,0 +1,116 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+// Collects textured quads and draws them with one draw call per texture.
+// Layers keep their vertex storage between frames, so steady-state frames don't allocate.
+class SpriteBatch final : public sf::Drawable
+{
+    struct Layer
+    {
+        const sf::Texture *texture;
+        sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+    };
+
+    // Drawn in the order their textures were first added
+    std::vector<Layer> layers{};
+
+    public:
+        // Empties every layer but keeps the memory for the next frame
+        void clear()
+        {
+            for (Layer &layer : layers)
+            {
+                layer.vertices.clear();
+            }
+        }
+
+        // Adds texture_rect of texture scaled by scale and centered at center
+        void addCentered(const sf::Texture &texture,
+                         const sf::IntRect &texture_rect,
+                         const sf::Vector2f &center,
+                         const sf::Vector2f &scale)
+        {
+            const sf::Vector2f size = sf::Vector2f(texture_rect.size).componentWiseMul(scale);
+            add(texture, texture_rect, center - size / 2.0f, size);
+        }
+
+        // Adds texture_rect of texture stretched over the rectangle at top_left with the given size
+        void add(const sf::Texture &texture,
+                 const sf::IntRect &texture_rect,
+                 const sf::Vector2f &top_left,
+                 const sf::Vector2f &size)
+        {
+            sf::VertexArray &vertices = findLayer(texture).vertices;
+
+            const sf::Vector2f tex_top_left{texture_rect.position};
+            const sf::Vector2f tex_bottom_right = tex_top_left + sf::Vector2f(texture_rect.size);
+            const sf::Vector2f bottom_right = top_left + size;
+
+            const sf::Vertex top_left_vertex{top_left, sf::Color::White, tex_top_left};
+            const sf::Vertex top_right_vertex{
+                {bottom_right.x, top_left.y}, sf::Color::White, {tex_bottom_right.x, tex_top_left.y}
+            };
+            const sf::Vertex bottom_left_vertex{
+                {top_left.x, bottom_right.y}, sf::Color::White, {tex_top_left.x, tex_bottom_right.y}
+            };
+            const sf::Vertex bottom_right_vertex{bottom_right, sf::Color::White, tex_bottom_right};
+
+            // Two triangles per quad
+            vertices.append(top_left_vertex);
+            vertices.append(top_right_vertex);
+            vertices.append(bottom_left_vertex);
+            vertices.append(bottom_left_vertex);
+            vertices.append(top_right_vertex);
+            vertices.append(bottom_right_vertex);
+        }
+
+        [[nodiscard]] std::size_t getDrawCallCount() const
+        {
+            std::size_t count = 0;
+            for (const Layer &layer : layers)
+            {
+                if (layer.vertices.getVertexCount() != 0)
+                {
+                    ++count;
+                }
+            }
+
+            return count;
+        }
+
+    protected:
+        void draw(sf::RenderTarget &target, sf::RenderStates states) const override
+        {
+            for (const Layer &layer : layers)
+            {
+                if (layer.vertices.getVertexCount() == 0)
+                {
+                    continue;
+                }
+
+                states.texture = layer.texture;
+                target.draw(layer.vertices, states);
+            }
+        }
+
+    private:
+        Layer &findLayer(const sf::Texture &texture)
+        {
+            // There are only a handful of textures, a linear search beats hashing here
+            for (Layer &layer : layers)
+            {
+                if (layer.texture == &texture)
+                {
+                    return layer;
+                }
+            }
+
+            return layers.emplace_back(Layer{&texture});
+        }
+};
+
+#endif //SPRITEBATCH_H
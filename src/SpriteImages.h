@@ -0,0 +1,57 @@
+#ifndef SPRITEIMAGES_H
+#define SPRITEIMAGES_H
+
+#include <array>
+#include <filesystem>
+
+#include <memory>
+
+#include <SFML/Graphics.hpp>
+
+#include "ResourceRegistry.h"
+
+// CPU-side copies of every sprite image. Decoding an sf::Image needs neither a window nor a GL context,
+// so the simulation can read sprite sizes (and the barrier's pixels) from here when running headless.
+// Copies share the images.
+struct SpriteImages
+{
+    // Indexed by Alien::typeIndex(), each with two animation frames
+    std::array<std::array<ResourceHandle<sf::Image>, 2>, 3> aliens;
+    ResourceHandle<sf::Image> explosion;
+    ResourceHandle<sf::Image> bullet;
+    ResourceHandle<sf::Image> spaceship;
+    ResourceHandle<sf::Image> barrier;
+
+    // Decodes every image one after another, throws if one can't be read
+    static SpriteImages load(const std::filesystem::path &images_dir)
+    {
+        SpriteImages images;
+        images.forEachFile([&images_dir](ResourceHandle<sf::Image> &image, const char *file_name)
+        {
+            image = std::make_shared<const sf::Image>(images_dir / file_name);
+        });
+
+        return images;
+    }
+
+    // Calls on_file with every image and the name of its file in the images directory
+    template<typename OnFile>
+    void forEachFile(OnFile &&on_file)
+    {
+        constexpr std::array<std::array<const char *, 2>, 3> alien_files = {
+            {{"alien3a.png", "alien3b.png"}, {"alien2a.png", "alien2b.png"}, {"alien1a.png", "alien1b.png"}}
+        };
+        for (std::size_t type = 0; type < aliens.size(); ++type)
+        {
+            on_file(aliens[type][0], alien_files[type][0]);
+            on_file(aliens[type][1], alien_files[type][1]);
+        }
+
+        on_file(explosion, "alienExplosion.png");
+        on_file(bullet, "bullet.png");
+        on_file(spaceship, "spaceship.png");
+        on_file(barrier, "barrier.png");
+    }
+};
+
+#endif //SPRITEIMAGES_H
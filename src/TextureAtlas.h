@@ -0,0 +1,134 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+// Packs many small images into one texture so every sprite can be drawn from a single texture and batch.
+// Images are queued with add(), which hands out a handle, and packed by build(). A handle resolves to the
+// image's rectangle inside the atlas texture.
+class TextureAtlas
+{
+    // Transparent gap around every image so neighbours never bleed into each other
+    static constexpr unsigned int padding = 1;
+
+    std::vector<const sf::Image *> pending_images{};
+    std::vector<sf::IntRect> regions{};
+    sf::Texture texture;
+
+    // Reused for partial uploads, which need the pixels of the updated area to be contiguous
+    std::vector<std::uint8_t> staging_pixels{};
+
+    public:
+        using Handle = std::size_t;
+
+        // The image must stay alive until build() is called
+        Handle add(const sf::Image &image)
+        {
+            pending_images.emplace_back(&image);
+            return pending_images.size() - 1;
+        }
+
+        // Packs all added images into rows sorted by height and uploads the result.
+        // Returns false if the atlas texture could not be created.
+        bool build()
+        {
+            std::vector<Handle> order(pending_images.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [this](const Handle a, const Handle b)
+            {
+                return pending_images[a]->getSize().y > pending_images[b]->getSize().y;
+            });
+
+            // Grow the atlas width until everything fits into a roughly square area
+            unsigned int width = 64;
+            for (const sf::Image *image : pending_images)
+            {
+                width = std::max(width, image->getSize().x + padding);
+            }
+
+            sf::Vector2u size = pack(order, width);
+            while (size.y > width)
+            {
+                width *= 2;
+                size = pack(order, width);
+            }
+
+            sf::Image atlas_image{size, sf::Color::Transparent};
+            for (Handle handle = 0; handle < pending_images.size(); ++handle)
+            {
+                if (!atlas_image.copy(*pending_images[handle], sf::Vector2u(regions[handle].position)))
+                {
+                    std::cerr << "Error copying image into the texture atlas\n";
+                }
+            }
+
+            pending_images.clear();
+
+            return texture.loadFromImage(atlas_image);
+        }
+
+        [[nodiscard]] const sf::IntRect &getRect(const Handle handle) const
+        {
+            return regions[handle];
+        }
+
+        [[nodiscard]] const sf::Texture &getTexture() const
+        {
+            return texture;
+        }
+
+        // Uploads the given area of a region's image, which must have the region's size. Area is in image coordinates.
+        void update(const Handle handle, const sf::Image &image, const sf::IntRect &area)
+        {
+            const sf::Vector2u size{area.size};
+            const std::size_t row_bytes = std::size_t{size.x} * 4;
+            const std::size_t image_row_bytes = std::size_t{image.getSize().x} * 4;
+
+            staging_pixels.resize(row_bytes * size.y);
+            const std::uint8_t *source = image.getPixelsPtr() + area.position.y * image_row_bytes + area.position.x *
+                4;
+            for (unsigned int row = 0; row < size.y; ++row)
+            {
+                std::copy_n(source + row * image_row_bytes, row_bytes, staging_pixels.data() + row * row_bytes);
+            }
+
+            texture.update(staging_pixels.data(), size, sf::Vector2u(regions[handle].position + area.position));
+        }
+
+    private:
+        // Assigns regions row by row for the given width, returns the resulting atlas size
+        sf::Vector2u pack(const std::vector<Handle> &order, const unsigned int width)
+        {
+            regions.assign(pending_images.size(), {});
+
+            unsigned int x = 0;
+            unsigned int y = 0;
+            unsigned int row_height = 0;
+            for (const Handle handle : order)
+            {
+                const sf::Vector2u image_size = pending_images[handle]->getSize();
+
+                if (x + image_size.x + padding > width && x != 0)
+                {
+                    x = 0;
+                    y += row_height;
+                    row_height = 0;
+                }
+
+                regions[handle] = {sf::Vector2i(sf::Vector2u{x, y}), sf::Vector2i(image_size)};
+
+                x += image_size.x + padding;
+                row_height = std::max(row_height, image_size.y + padding);
+            }
+
+            return {width, y + row_height};
+        }
+};
+
+#endif //TEXTUREATLAS_H
@@ -0,0 +1,213 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed set of worker threads with one task queue each. Workers take their newest task first (it's likely still
+// in cache) and, once their own queue is empty, steal the oldest task from another worker's queue. Tasks submitted
+// from a worker go to that worker's queue, tasks submitted from elsewhere are spread round robin.
+// Meant for coarse tasks, every queue has its own mutex.
+class ThreadPool
+{
+    using Task = std::function<void()>;
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    // Index of the worker the calling thread is in this pool, if any
+    static inline thread_local const ThreadPool *current_pool = nullptr;
+    static inline thread_local std::size_t current_worker = 0;
+
+    std::atomic<std::size_t> next_queue{0};
+
+    // Guards the counters below and lets idle workers and wait() sleep
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable all_done;
+    // Tasks sitting in a queue
+    std::size_t queued = 0;
+    // Tasks submitted and not yet finished
+    std::size_t unfinished = 0;
+    bool stopping = false;
+    // First exception thrown by a task, rethrown by wait()
+    std::exception_ptr failure{};
+
+    public:
+        explicit ThreadPool(const std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            for (std::size_t i = 0; i < thread_count; ++i)
+            {
+                queues.emplace_back(std::make_unique<Queue>());
+            }
+
+            for (std::size_t i = 0; i < thread_count; ++i)
+            {
+                workers.emplace_back([this, i]
+                {
+                    work(i);
+                });
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Finishes every task already submitted, then stops the workers
+        ~ThreadPool()
+        {
+            {
+                const std::lock_guard lock{state_mutex};
+                stopping = true;
+            }
+            work_available.notify_all();
+
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        void submit(Task task)
+        {
+            const std::size_t index = current_pool == this
+                                          ? current_worker
+                                          : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+            // Counted before it's visible to the workers, so they never finish a task that isn't counted yet
+            {
+                const std::lock_guard lock{state_mutex};
+                ++queued;
+                ++unfinished;
+            }
+
+            {
+                const std::lock_guard lock{queues[index]->mutex};
+                queues[index]->tasks.push_back(std::move(task));
+            }
+            work_available.notify_one();
+        }
+
+        // Blocks until every submitted task has finished. Rethrows the first exception a task threw.
+        // Must not be called from a worker.
+        void wait()
+        {
+            std::unique_lock lock{state_mutex};
+            all_done.wait(lock, [this]
+            {
+                return unfinished == 0;
+            });
+
+            if (failure)
+            {
+                std::rethrow_exception(std::exchange(failure, nullptr));
+            }
+        }
+
+        [[nodiscard]] std::size_t getThreadCount() const
+        {
+            return workers.size();
+        }
+
+    private:
+        void work(const std::size_t index)
+        {
+            current_pool = this;
+            current_worker = index;
+
+            while (true)
+            {
+                if (std::optional<Task> task = takeTask(index))
+                {
+                    run(*task);
+                    continue;
+                }
+
+                std::unique_lock lock{state_mutex};
+                work_available.wait(lock, [this]
+                {
+                    return stopping || queued != 0;
+                });
+
+                if (stopping && queued == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        // Own newest task, or else the oldest task of the first other worker that has one
+        std::optional<Task> takeTask(const std::size_t index)
+        {
+            for (std::size_t offset = 0; offset < queues.size(); ++offset)
+            {
+                Queue &queue = *queues[(index + offset) % queues.size()];
+
+                std::unique_lock lock{queue.mutex};
+                if (queue.tasks.empty())
+                {
+                    continue;
+                }
+
+                Task task;
+                if (offset == 0)
+                {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                }
+                else
+                {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+                lock.unlock();
+
+                const std::lock_guard state_lock{state_mutex};
+                --queued;
+                return task;
+            }
+
+            return std::nullopt;
+        }
+
+        void run(Task &task)
+        {
+            std::exception_ptr exception{};
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            const std::lock_guard lock{state_mutex};
+            if (exception && !failure)
+            {
+                failure = exception;
+            }
+
+            if (--unfinished == 0)
+            {
+                all_done.notify_all();
+            }
+        }
+};
+
+#endif //THREADPOOL_H
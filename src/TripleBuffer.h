@@ -0,0 +1,58 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands the latest value from one writer thread to one reader thread without locks or waiting. The writer fills the
+// back slot and publishes it, the reader picks up the newest published slot, values published in between are
+// skipped. Neither side ever sees a slot the other one is using.
+template<typename Value>
+class TripleBuffer
+{
+    // Set in middle when it holds a slot the reader hasn't picked up yet
+    static constexpr std::uint8_t fresh = 4;
+    static constexpr std::uint8_t index_mask = 3;
+
+    std::array<Value, 3> slots{};
+    // Owned by the writer
+    std::uint8_t back = 0;
+    // The slot between the two, swapped with back on publish() and with front on update()
+    std::atomic<std::uint8_t> middle{1};
+    // Owned by the reader
+    std::uint8_t front = 2;
+
+    public:
+        // Writer side: the slot to fill next. It holds whatever was published into it three slots ago.
+        [[nodiscard]] Value &getBack()
+        {
+            return slots[back];
+        }
+
+        // Writer side: makes the back slot the newest value
+        void publish()
+        {
+            back = middle.exchange(back | fresh, std::memory_order_acq_rel) & index_mask;
+        }
+
+        // Reader side: switches to the newest published value, returns false if there was none since the last call
+        bool update()
+        {
+            if (!(middle.load(std::memory_order_relaxed) & fresh))
+            {
+                return false;
+            }
+
+            front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+            return true;
+        }
+
+        // Reader side: the value picked up by the last update()
+        [[nodiscard]] const Value &getFront() const
+        {
+            return slots[front];
+        }
+};
+
+#endif //TRIPLEBUFFER_H
@@ -1,8 +1,13 @@
 #ifndef UTILS_H
 #define UTILS_H
+#include <cstdint>
 #include <ostream>
 #include <SFML/System/Vector2.hpp>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 template<typename T>
 std::ostream &operator<<(std::ostream &os, const sf::Vector2<T> &vec)
 {
@@ -10,4 +15,28 @@ std::ostream &operator<<(std::ostream &os, const sf::Vector2<T> &vec)
     return os;
 }
 
+// Index of the lowest set bit, value must not be 0
+inline unsigned int lowestSetBit(const std::uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return static_cast<unsigned int>(__builtin_ctzll(value));
+#endif
+}
+
+// Index of the highest set bit, value must not be 0
+inline unsigned int highestSetBit(const std::uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63 - static_cast<unsigned int>(__builtin_clzll(value));
+#endif
+}
+
 #endif //UTILS_H
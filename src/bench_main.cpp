@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AlienManager.h"
+#include "Barrier.h"
+#include "BulletManager.h"
+
+// Microbenchmarks for the simulation's hot paths. Needs neither a window nor a GL context, the sprites are
+// replaced by images of the same size as the shipped ones.
+// Usage: space_invaders_bench [results.json]
+
+namespace
+{
+    const std::array<sf::Vector2u, 3> alien_sizes{sf::Vector2u{16, 16}, sf::Vector2u{22, 16}, sf::Vector2u{24, 16}};
+    const sf::Vector2u bullet_size{15, 15};
+    const sf::Vector2u barrier_size{26, 18};
+    constexpr float alien_scale = 3.0f;
+    constexpr float barrier_scale = 8.0f;
+
+    // Results are summed into this so the compiler can't drop the measured work
+    volatile long sink = 0;
+
+    struct Result
+    {
+        std::string name;
+        std::string parameter;
+        long value;
+        double median_ns;
+        double min_ns;
+        std::size_t runs;
+    };
+
+    class Bench
+    {
+        static constexpr std::size_t min_runs = 20;
+        static constexpr std::size_t max_runs = 100'000;
+        static constexpr std::chrono::milliseconds min_time{200};
+
+        std::vector<Result> results{};
+
+        public:
+            // Calls setup (untimed) and run (timed) until enough time has passed. run must do ops_per_run
+            // operations, results are in nanoseconds per operation.
+            void measure(const std::string &name,
+                         const std::string &parameter,
+                         const long value,
+                         const std::size_t ops_per_run,
+                         const std::function<void()> &setup,
+                         const std::function<void()> &run)
+            {
+                using clock = std::chrono::steady_clock;
+
+                std::vector<double> samples;
+                const auto start = clock::now();
+                while (samples.size() < min_runs || (clock::now() - start < min_time && samples.size() < max_runs))
+                {
+                    setup();
+                    const auto run_start = clock::now();
+                    run();
+                    const std::chrono::duration<double, std::nano> elapsed = clock::now() - run_start;
+                    samples.push_back(elapsed.count() / ops_per_run);
+                }
+
+                std::sort(samples.begin(), samples.end());
+                const Result &result = results.emplace_back(Result{
+                    name, parameter, value, samples[samples.size() / 2], samples.front(), samples.size()
+                });
+
+                std::cout << result.name << " (" << result.parameter << " = " << result.value << "): "
+                        << result.median_ns << " ns/op median, " << result.min_ns << " ns/op min, "
+                        << result.runs << " runs\n";
+            }
+
+            bool writeJson(const std::string &path) const
+            {
+                std::ofstream file{path, std::ios::trunc};
+                if (!file)
+                {
+                    return false;
+                }
+
+                file << "{\"benchmarks\":[";
+                for (std::size_t i = 0; i < results.size(); ++i)
+                {
+                    const Result &result = results[i];
+                    file << (i == 0 ? "\n" : ",\n")
+                            << R"({"name":")" << result.name << R"(","parameter":")" << result.parameter
+                            << R"(","value":)" << result.value << R"(,"median_ns":)" << result.median_ns
+                            << R"(,"min_ns":)" << result.min_ns << R"(,"runs":)" << result.runs << "}";
+                }
+                file << "\n]}\n";
+
+                return static_cast<bool>(file);
+            }
+    };
+
+    AlienManager makeAlienManager(const unsigned int rows, const unsigned int cols)
+    {
+        return AlienManager{
+            alien_sizes, {96.0f, 108.0f}, {1824.0f, 756.0f}, 5.0f, 500.0f, 5.0f, alien_scale, 0,
+            AlienManager::Formation::make(rows, cols)
+        };
+    }
+
+    // Restarts the formation and shoots aliens in random order until alive_count are left
+    void killAliensDownTo(AlienManager &alien_manager, const unsigned int alive_count, std::mt19937 &rng)
+    {
+        alien_manager.restart();
+
+        std::vector<unsigned int> order(alien_manager.getCount());
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        for (std::size_t i = alive_count; i < order.size(); ++i)
+        {
+            const sf::Vector2f center = alien_manager.getPosition(order[i]);
+            sink = sink + alien_manager.handleCollision(
+                Bullet::create(bullet_size, 0.0f, center - sf::Vector2f{1.0f, 0.0f}, Bullet::Type::Player));
+        }
+    }
+
+    void benchAliens(Bench &bench, const unsigned int rows, const unsigned int cols)
+    {
+        AlienManager alien_manager = makeAlienManager(rows, cols);
+        std::mt19937 rng{1};
+        const std::string formation = std::to_string(rows) + "x" + std::to_string(cols);
+
+        for (const unsigned int percent_alive : {100u, 50u, 10u})
+        {
+            const unsigned int alive_count = alien_manager.getCount() * percent_alive / 100;
+
+            // Bullets spread over the formation's area, most of them miss
+            constexpr std::size_t bullet_count = 256;
+            std::vector<Bullet> bullets;
+            bench.measure("AlienManager::handleCollision/" + formation, "percent_alive", percent_alive,
+                          bullet_count, [&]
+            {
+                killAliensDownTo(alien_manager, alive_count, rng);
+
+                const sf::FloatRect area = alien_manager.getFormationBounds();
+                std::uniform_real_distribution<float> x{area.position.x, area.position.x + area.size.x};
+                std::uniform_real_distribution<float> y{area.position.y, area.position.y + area.size.y};
+                bullets.clear();
+                for (std::size_t i = 0; i < bullet_count; ++i)
+                {
+                    bullets.push_back(Bullet::create(bullet_size, 0.0f, {x(rng), y(rng)}, Bullet::Type::Player));
+                }
+            }, [&]
+            {
+                for (const Bullet &bullet : bullets)
+                {
+                    sink = sink + alien_manager.handleCollision(bullet);
+                }
+            });
+
+            constexpr std::size_t step_count = 64;
+            bench.measure("AlienManager::move/" + formation, "percent_alive", percent_alive, step_count, [&]
+            {
+                killAliensDownTo(alien_manager, alive_count, rng);
+            }, [&]
+            {
+                for (std::size_t i = 0; i < step_count; ++i)
+                {
+                    alien_manager.move(1.0f);
+                }
+                sink = sink + alien_manager.getTextureStep();
+            });
+        }
+    }
+
+    void benchBullets(Bench &bench)
+    {
+        std::mt19937 rng{2};
+
+        for (const long bullet_count : {10L, 100L, 1'000L, 10'000L})
+        {
+            // Bounds far enough away that no bullet leaves them during a run
+            BulletManager bullet_manager{bullet_size, -1'000'000, 1'000'000, 1.2f, 0.5f,
+                                         static_cast<std::size_t>(bullet_count)};
+
+            constexpr std::size_t step_count = 64;
+            bench.measure("BulletManager::move", "live_bullets", bullet_count, step_count, [&]
+            {
+                bullet_manager.restart();
+                std::uniform_real_distribution<float> x{0.0f, 1920.0f};
+                std::uniform_real_distribution<float> y{0.0f, 1080.0f};
+                while (bullet_manager.addBullet({x(rng), y(rng)}, Bullet::Type::Enemy))
+                {
+                }
+            }, [&]
+            {
+                for (std::size_t i = 0; i < step_count; ++i)
+                {
+                    bullet_manager.move(1.0f);
+                }
+                sink = sink + static_cast<long>(bullet_manager.alien_bullets.size());
+            });
+        }
+    }
+
+    // Restarts the barrier and hits it at hit_count random points inside its bounds
+    void damageBarrier(Barrier &barrier, const long hit_count, std::mt19937 &rng)
+    {
+        const sf::FloatRect bounds = barrier.getBounds();
+        std::uniform_real_distribution<float> x{bounds.position.x, bounds.position.x + bounds.size.x};
+        std::uniform_real_distribution<float> y{bounds.position.y, bounds.position.y + bounds.size.y};
+
+        for (long i = 0; i < hit_count; ++i)
+        {
+            sink = sink + barrier.handleCollision(
+                Bullet::create(bullet_size, 0.0f, {x(rng), y(rng)}, Bullet::Type::Enemy));
+        }
+    }
+
+    void benchBarrier(Bench &bench)
+    {
+        const auto image = std::make_shared<const sf::Image>(barrier_size, sf::Color::Green);
+        Barrier barrier{image, barrier_scale, {288.0f, 702.0f}, 0};
+        std::mt19937 rng{3};
+
+        for (const long prior_hits : {0L, 50L, 200L})
+        {
+            constexpr long hit_count = 64;
+            bench.measure("Barrier::handleCollision", "prior_hits", prior_hits, hit_count, [&]
+            {
+                barrier.restart(0);
+                damageBarrier(barrier, prior_hits, rng);
+            }, [&]
+            {
+                damageBarrier(barrier, hit_count, rng);
+            });
+        }
+
+        // The CPU side of re-uploading a damaged barrier: the texture upload itself needs a GL context
+        for (const long hits_per_frame : {1L, 10L, 100L})
+        {
+            bench.measure("Barrier::takeDirtyRect", "hits_per_frame", hits_per_frame, 1, [&]
+            {
+                barrier.restart(0);
+                sink = sink + barrier.takeDirtyRect().has_value();
+                damageBarrier(barrier, hits_per_frame, rng);
+            }, [&]
+            {
+                sink = sink + barrier.takeDirtyRect().has_value();
+            });
+        }
+    }
+}
+
+int main(const int argc, char *argv[])
+{
+    const std::string output_path = argc > 1 ? argv[1] : "bench_results.json";
+
+    Bench bench;
+    // The arcade formation and swarms up to the largest load scenario
+    benchAliens(bench, 5, 10);
+    benchAliens(bench, 20, 50);
+    benchAliens(bench, 100, 200);
+    benchBullets(bench);
+    benchBarrier(bench);
+
+    if (!bench.writeJson(output_path))
+    {
+        std::cerr << "Error writing " << output_path << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Results written to " << output_path << '\n';
+
+    return EXIT_SUCCESS;
+}
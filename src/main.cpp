@@ -1,7 +1,283 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "AssetLoader.h"
+#include "BatchRunner.h"
 #include "GameManager.h"
+#include "InputPolicy.h"
+
+// From the asset pack if the build made one, else decoded from the image files
+static SpriteImages loadSpriteImages()
+{
+    const std::optional<AssetPack> pack = AssetPack::open(AssetLoader::findPack());
+    const std::filesystem::path images_dir = AssetLoader::findRoot() / "images";
+    if (!pack)
+    {
+        return SpriteImages::load(images_dir);
+    }
+
+    SpriteImages images;
+    images.forEachFile([&pack, &images_dir](ResourceHandle<sf::Image> &image, const char *file_name)
+    {
+        std::optional<sf::Image> packed = pack->getImage(std::string{"images/"} + file_name);
+        image = std::make_shared<const sf::Image>(packed ? std::move(*packed) : sf::Image(images_dir / file_name));
+    });
+
+    return images;
+}
+
+static void printUsage(std::ostream &stream)
+{
+    stream << "Usage: space_invaders [--audio on|off] [--formation ROWSxCOLS]\n"
+            << "       space_invaders --headless TICKS [--formation ROWSxCOLS]\n"
+            << "       space_invaders --batch GAMES [--policy NAME] [--max-ticks TICKS] [--threads COUNT]"
+            << " [--formation ROWSxCOLS]\n"
+            << "       space_invaders --replay FILE\n";
+}
+
+// The whole of text as a positive number, nothing if it's anything else or out of Number's range
+template<typename Number>
+static std::optional<Number> parsePositive(const std::string_view text)
+{
+    Number value{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size() || value <= 0)
+    {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+// Steps the simulation without opening a window or an audio device, e.g. for soak tests
+static int runHeadless(const long ticks, const AlienManager::Formation &formation)
+{
+    const SpriteImages images = loadSpriteImages();
+    Simulation simulation{images, 0, formation};
+
+    SweepPolicy policy;
+    int games = 1;
+    std::size_t pairs_tested = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (long tick = 0; tick < ticks; ++tick)
+    {
+        simulation.step(policy.nextInput(simulation));
+        pairs_tested += simulation.getCollisionStats().pairs_tested;
+
+        if (simulation.isGameOver())
+        {
+            simulation.reset(static_cast<std::uint32_t>(games++));
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << ticks << " ticks in " << elapsed.count() << " s (" << ticks / elapsed.count() << " ticks/s), "
+            << games << " game(s), final score " << simulation.getScore() << ", "
+            << static_cast<double>(pairs_tested) / ticks << " collision pairs tested per tick\n";
+
+    return EXIT_SUCCESS;
+}
+
+// Plays game_count games on every core and prints a summary of how they went
+static int runBatch(const std::size_t game_count,
+                    const std::string &policy_name,
+                    const long max_ticks,
+                    const std::size_t thread_count,
+                    const AlienManager::Formation &formation)
+{
+    if (!makeInputPolicy(policy_name, 0))
+    {
+        std::cerr << "Unknown input policy " << policy_name << ", expected one of:";
+        for (const std::string_view name : input_policy_names)
+        {
+            std::cerr << ' ' << name;
+        }
+        std::cerr << '\n';
+        return EXIT_FAILURE;
+    }
+
+    const SpriteImages images = loadSpriteImages();
+    const BatchRunner runner{images, formation, policy_name, max_ticks};
+    ThreadPool pool{thread_count};
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<BatchRunner::GameResult> results = runner.run(game_count, 0, pool);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-int main()
+    long total_ticks = 0;
+    for (const BatchRunner::GameResult &result : results)
+    {
+        total_ticks += result.ticks;
+    }
+
+    std::cout << game_count << " game(s) of " << policy_name << " on " << pool.getThreadCount() << " thread(s) in "
+            << elapsed.count() << " s (" << total_ticks / elapsed.count() << " ticks/s)\n";
+    BatchRunner::printSummary(results, std::cout);
+
+    return EXIT_SUCCESS;
+}
+
+// Plays a recorded game back as fast as possible and checks that it ends the way it did when it was recorded
+static int runReplay(const std::filesystem::path &path)
+{
+    const std::optional<Replay> replay = Replay::load(path);
+    if (!replay)
+    {
+        std::cerr << "Could not read replay " << path << '\n';
+        return EXIT_FAILURE;
+    }
+
+    const SpriteImages images = loadSpriteImages();
+    Simulation simulation{images, replay->getSeed(), replay->getFormation()};
+
+    const auto start = std::chrono::steady_clock::now();
+    replay->forEachInput([&simulation](const Input &input)
+    {
+        simulation.step(input);
+    });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const bool score_matches = simulation.getScore() == replay->getFinalScore();
+    const bool state_matches = simulation.getStateHash() == replay->getFinalStateHash();
+
+    std::cout << replay->getTickCount() << " ticks in " << elapsed.count() << " s ("
+            << replay->getTickCount() / elapsed.count() << " ticks/s), final score " << simulation.getScore()
+            << " (recorded " << replay->getFinalScore() << "), final state "
+            << (state_matches ? "matches" : "differs from") << " the recording\n";
+
+    return score_matches && state_matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Parses ROWSxCOLS, e.g. 100x200, of at most AlienManager::Formation::max_aliens aliens
+static std::optional<AlienManager::Formation> parseFormation(const std::string_view text)
 {
-    GameManager manager{};
+    const std::size_t separator = text.find('x');
+    if (separator == std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+
+    const std::optional rows = parsePositive<unsigned int>(text.substr(0, separator));
+    const std::optional cols = parsePositive<unsigned int>(text.substr(separator + 1));
+    if (!rows || !cols || std::uint64_t{*rows} * *cols > AlienManager::Formation::max_aliens)
+    {
+        return std::nullopt;
+    }
+
+    return AlienManager::Formation::make(*rows, *cols);
+}
+
+int main(const int argc, char *argv[])
+{
+    std::optional<long> headless_ticks;
+    std::optional<std::filesystem::path> replay_path;
+    std::optional<std::size_t> batch_games;
+    std::string policy_name = "tracker";
+    // Ten minutes of play
+    long max_ticks = 10L * 60 * Simulation::tick_rate;
+    std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    AlienManager::Formation formation = AlienManager::Formation::make();
+    bool muted = false;
+
+    // Every option takes a value
+    for (int i = 1; i < argc; i += 2)
+    {
+        const std::string_view option = argv[i];
+        if (i + 1 == argc)
+        {
+            std::cerr << "Missing value for " << option << '\n';
+            printUsage(std::cerr);
+            return EXIT_FAILURE;
+        }
+
+        const std::string_view value = argv[i + 1];
+        bool valid = true;
+        if (option == "--headless")
+        {
+            headless_ticks = parsePositive<long>(value);
+            valid = headless_ticks.has_value();
+        }
+        else if (option == "--batch")
+        {
+            batch_games = parsePositive<std::size_t>(value);
+            valid = batch_games.has_value();
+        }
+        else if (option == "--policy")
+        {
+            policy_name = value;
+        }
+        else if (option == "--max-ticks")
+        {
+            const std::optional parsed = parsePositive<long>(value);
+            max_ticks = parsed.value_or(max_ticks);
+            valid = parsed.has_value();
+        }
+        else if (option == "--threads")
+        {
+            const std::optional parsed = parsePositive<std::size_t>(value);
+            thread_count = parsed.value_or(thread_count);
+            valid = parsed.has_value();
+        }
+        else if (option == "--replay")
+        {
+            replay_path = value;
+        }
+        else if (option == "--audio")
+        {
+            muted = value == "off";
+            valid = muted || value == "on";
+        }
+        else if (option == "--formation")
+        {
+            if (const std::optional parsed = parseFormation(value))
+            {
+                formation = *parsed;
+            }
+            else
+            {
+                std::cerr << "Invalid formation " << value << ", expected ROWSxCOLS\n";
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown option " << option << '\n';
+            printUsage(std::cerr);
+            return EXIT_FAILURE;
+        }
+
+        if (!valid)
+        {
+            std::cerr << "Invalid value " << value << " for " << option << '\n';
+            printUsage(std::cerr);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (batch_games)
+    {
+        return runBatch(*batch_games, policy_name, max_ticks, thread_count, formation);
+    }
+
+    if (replay_path)
+    {
+        return runReplay(*replay_path);
+    }
+
+    if (headless_ticks)
+    {
+        return runHeadless(*headless_ticks, formation);
+    }
+
+    GameManager manager{formation, muted};
     manager.run();
 }
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+#include "AudioService.h"
+
+// Build step that decodes everything below the assets directory into one AssetPack.
+// Usage: space_invaders_pack <assets directory> <output pack>
+
+namespace
+{
+    std::string extension(const std::filesystem::path &path)
+    {
+        std::string result = path.extension().string();
+        std::transform(result.begin(), result.end(), result.begin(), [](const unsigned char c)
+        {
+            return static_cast<char>(std::tolower(c));
+        });
+        return result;
+    }
+
+    std::vector<std::uint8_t> readBytes(const std::filesystem::path &path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        if (!file)
+        {
+            throw std::runtime_error("Failed to read " + path.string());
+        }
+
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+}
+
+int main(const int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: space_invaders_pack <assets directory> <output pack>\n";
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path assets_dir = argv[1];
+    const std::filesystem::path output_path = argv[2];
+
+    AssetPack::Writer writer;
+    std::size_t asset_count = 0;
+    try
+    {
+        for (const auto &file : std::filesystem::recursive_directory_iterator(assets_dir))
+        {
+            if (!file.is_regular_file())
+            {
+                continue;
+            }
+
+            const std::string name = file.path().lexically_relative(assets_dir).generic_string();
+            const std::string type = extension(file.path());
+            if (type == ".png" || type == ".bmp" || type == ".tga" || type == ".jpg")
+            {
+                writer.addImage(name, sf::Image{file.path()});
+            }
+            else if (type == ".wav" || type == ".ogg" || type == ".flac" || type == ".mp3")
+            {
+                writer.addSound(name, SoundSamples::decode(file.path()));
+            }
+            else if (type == ".ttf" || type == ".otf")
+            {
+                writer.addBytes(name, readBytes(file.path()));
+            }
+            else
+            {
+                // Such as the high score, which changes at runtime
+                continue;
+            }
+
+            ++asset_count;
+        }
+    }
+    catch (const std::exception &exception)
+    {
+        std::cerr << exception.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (!writer.write(output_path))
+    {
+        std::cerr << "Error writing " << output_path << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Packed " << asset_count << " assets into " << output_path << '\n';
+
+    return EXIT_SUCCESS;
+}